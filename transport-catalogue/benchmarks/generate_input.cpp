@@ -0,0 +1,107 @@
+// Writes a random make_base style input with Stop and Bus stat requests to stdout.
+// Usage: generate_input STOP_COUNT BUS_COUNT REQUEST_COUNT [SEED]
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string GetStopName(int stop) {
+    return "Stop " + std::to_string(stop);
+}
+
+std::string GetBusName(int bus) {
+    return "Bus " + std::to_string(bus);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " STOP_COUNT BUS_COUNT REQUEST_COUNT [SEED]" << std::endl;
+        return 1;
+    }
+    const int stop_count = std::atoi(argv[1]);
+    const int bus_count = std::atoi(argv[2]);
+    const int request_count = std::atoi(argv[3]);
+    std::mt19937 random(argc > 4 ? std::atoi(argv[4]) : 1);
+    if (stop_count < 2 || bus_count < 0 || request_count < 0) {
+        std::cerr << "At least two stops are needed" << std::endl;
+        return 1;
+    }
+    std::uniform_int_distribution<int> random_stop(0, stop_count - 1);
+    std::uniform_int_distribution<int> random_bus(0, std::max(bus_count - 1, 0));
+    std::uniform_int_distribution<int> random_route_size(2, 8);
+    std::uniform_int_distribution<int> random_distance(100, 5000);
+    std::uniform_real_distribution<double> random_offset(0.0, 0.3);
+
+    // every pair of consecutive stops of a bus gets a distance in one direction at least
+    std::vector<std::map<int, int>> distances(stop_count);
+    std::vector<std::vector<int>> routes(bus_count);
+    std::vector<bool> is_roundtrip(bus_count);
+    for (int bus = 0; bus < bus_count; ++bus) {
+        std::vector<int>& route = routes[bus];
+        route.resize(random_route_size(random));
+        for (int& stop : route) {
+            stop = random_stop(random);
+        }
+        is_roundtrip[bus] = random() % 2 == 0;
+        if (is_roundtrip[bus]) {
+            route.push_back(route.front());
+        }
+        for (size_t i = 0; i + 1 < route.size(); ++i) {
+            const int from = route[i];
+            const int to = route[i + 1];
+            if (distances[from].count(to) == 0 && distances[to].count(from) == 0) {
+                distances[from][to] = random_distance(random);
+            }
+        }
+    }
+
+    std::ostream& out = std::cout;
+    out.precision(9);
+    out << "{\n  \"base_requests\": [\n";
+    for (int stop = 0; stop < stop_count; ++stop) {
+        out << "    {\"type\": \"Stop\", \"name\": \"" << GetStopName(stop) << "\", \"latitude\": "
+            << 55.5 + random_offset(random) << ", \"longitude\": " << 37.4 + random_offset(random)
+            << ", \"road_distances\": {";
+        bool is_first = true;
+        for (const auto& [to, distance] : distances[stop]) {
+            out << (is_first ? "" : ", ") << '"' << GetStopName(to) << "\": " << distance;
+            is_first = false;
+        }
+        out << "}}" << (stop + 1 < stop_count || bus_count > 0 ? ",\n" : "\n");
+    }
+    for (int bus = 0; bus < bus_count; ++bus) {
+        out << "    {\"type\": \"Bus\", \"name\": \"" << GetBusName(bus) << "\", \"stops\": [";
+        for (size_t i = 0; i < routes[bus].size(); ++i) {
+            out << (i == 0 ? "" : ", ") << '"' << GetStopName(routes[bus][i]) << '"';
+        }
+        out << "], \"is_roundtrip\": " << (is_roundtrip[bus] ? "true" : "false") << '}'
+            << (bus + 1 < bus_count ? ",\n" : "\n");
+    }
+    out << "  ],\n";
+    out << R"(  "render_settings": {"width": 1200, "height": 800, "padding": 50, "stop_radius": 5, "line_width": 14,)"
+        << R"( "bus_label_font_size": 20, "bus_label_offset": [7, 15], "stop_label_font_size": 18,)"
+        << R"( "stop_label_offset": [7, -3], "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3,)"
+        << R"( "color_palette": ["green", [255, 160, 0], "red"]},)" << '\n';
+    out << R"(  "routing_settings": {"bus_wait_time": 6, "bus_velocity": 40},)" << '\n';
+    out << "  \"stat_requests\": [\n";
+    for (int id = 0; id < request_count; ++id) {
+        // a tenth of the requests ask for a stop or a bus that does not exist
+        const bool is_stop = random() % 2 == 0;
+        const bool is_known = random() % 10 != 0 && (is_stop || bus_count > 0);
+        std::string name = is_stop ? GetStopName(random_stop(random)) : GetBusName(random_bus(random));
+        if (!is_known) {
+            name = "Unknown " + name;
+        }
+        out << "    {\"id\": " << id << ", \"type\": \"" << (is_stop ? "Stop" : "Bus") << "\", \"name\": \"" << name
+            << "\"}" << (id + 1 < request_count ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
@@ -0,0 +1,115 @@
+// Measures the time and the number of operator new calls of every step from the input text
+// to the answers, for the document and the streaming modes of JSONReader.
+// Usage: reader_benchmark INPUT_FILE [RUN_COUNT]
+// The input must only have Stop and Bus stat requests, see generate_input
+
+#include "json.h"
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "thread_pool.h"
+#include "transport_catalogue.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <string>
+
+namespace {
+
+size_t allocation_count = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    ++allocation_count;
+    if (void* pointer = std::malloc(size != 0 ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Prints the time and the allocations of a step since the previous one
+class StepTimer {
+public:
+    void Step(const char* name) {
+        const Clock::time_point now = Clock::now();
+        std::printf("  %-16s %8.3f s %12zu allocs\n", name, std::chrono::duration<double>(now - start_).count(),
+                    allocation_count - start_allocations_);
+        start_ = Clock::now();
+        start_allocations_ = allocation_count;
+    }
+
+private:
+    Clock::time_point start_ = Clock::now();
+    size_t start_allocations_ = allocation_count;
+};
+
+void WriteAnswers(JSONReader& reader, const TransportCatalogue& catalogue) {
+    renderer::MapRenderer renderer(reader.GetRenderSettings());
+    RequestHandler handler(catalogue, renderer);
+    parallel::ThreadPool pool(1);
+    std::ostringstream out;
+    json::Writer writer(out);
+    reader.WriteAnswers(catalogue, handler, writer, pool);
+}
+
+void RunDocumentMode(const std::string& input) {
+    std::printf("document mode\n");
+    StepTimer timer;
+    JSONReader reader{std::string_view(input)};
+    timer.Step("parse");
+    TransportCatalogue catalogue;
+    reader.FillCatalogue(catalogue);
+    timer.Step("fill catalogue");
+    WriteAnswers(reader, catalogue);
+    timer.Step("answers");
+}
+
+void RunStreamingMode(const std::string& input) {
+    std::printf("streaming mode\n");
+    StepTimer timer;
+    TransportCatalogue catalogue;
+    JSONReader reader(input, catalogue);
+    timer.Step("parse and load");
+    reader.FillCatalogue(catalogue);
+    timer.Step("finalize");
+    WriteAnswers(reader, catalogue);
+    timer.Step("answers");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s INPUT_FILE [RUN_COUNT]\n", argv[0]);
+        return 1;
+    }
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return 1;
+    }
+    const std::string input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const int run_count = argc > 2 ? std::atoi(argv[2]) : 1;
+    for (int run = 0; run < run_count; ++run) {
+        RunDocumentMode(input);
+        RunStreamingMode(input);
+    }
+}
@@ -0,0 +1,486 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+/*
+ * Contraction Hierarchies: vertices are contracted one by one in the order of their importance,
+ * and a shortcut edge is added whenever contracting a vertex would break the only shortest path
+ * through it. A query is then a bidirectional Dijkstra that only goes up the hierarchy and settles
+ * a few hundred vertices even on large networks. Every shortcut remembers the two edges it
+ * replaces, so routes are unpacked back into edges of the original graph.
+ * Preprocessing keeps memory linear in the number of edges plus shortcuts.
+ */
+template <typename Weight>
+class ContractionHierarchy final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RoutingEngine<Weight>::RouteInfo;
+
+    explicit ContractionHierarchy(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    // Either an edge of the original graph (second == NO_EDGE, first is its id)
+    // or a shortcut for the path first + second of hierarchy edges
+    struct HierarchyEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId first;
+        EdgeId second;
+    };
+
+    struct Shortcut {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId first;
+        EdgeId second;
+    };
+
+    // Adjacency in compressed rows: edges of vertex v are ids[offsets[v]..offsets[v + 1])
+    struct Adjacency {
+        std::vector<size_t> offsets;
+        std::vector<EdgeId> ids;
+    };
+
+    struct Label {
+        Weight weight;
+        EdgeId prev_edge;
+    };
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    class Preprocessor;
+
+    EdgeId AddEdge(const HierarchyEdge& edge);
+    Adjacency MakeAdjacency(bool upward) const;
+    void SearchStep(Queue& queue, std::unordered_map<VertexId, Label>& labels, const Adjacency& adjacency,
+                    const Adjacency& stall_adjacency, bool forward) const;
+    void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    const Graph& graph_;
+    std::vector<HierarchyEdge> edges_;
+    std::vector<size_t> ranks_;
+    // Edges to higher-ranked vertices by their tail, used by the forward search
+    Adjacency upward_;
+    // Edges from higher-ranked vertices by their head, used by the backward search
+    Adjacency downward_;
+};
+
+/*
+ * Contracts vertices in the order of their edge difference (shortcuts added minus edges removed)
+ * plus the number of already contracted neighbours and the depth of the hierarchy below them,
+ * which spreads contraction evenly over the graph. Priorities are updated lazily: a vertex is
+ * re-evaluated when it reaches the top of the queue.
+ */
+template <typename Weight>
+class ContractionHierarchy<Weight>::Preprocessor {
+public:
+    explicit Preprocessor(ContractionHierarchy& hierarchy)
+        : hierarchy_(hierarchy)
+        , vertex_count_(hierarchy.graph_.GetVertexCount())
+        , out_edges_(vertex_count_)
+        , in_edges_(vertex_count_)
+        , contracted_(vertex_count_, false)
+        , contracted_neighbours_(vertex_count_, 0)
+        , levels_(vertex_count_, 0)
+        , witness_weights_(vertex_count_)
+        , is_target_(vertex_count_, false) {
+    }
+
+    void Run() {
+        const Graph& graph = hierarchy_.graph_;
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            // Loops never lie on a shortest path
+            if (edge.from != edge.to) {
+                AddEdge({edge.from, edge.to, edge.weight, edge_id, NO_EDGE});
+            }
+        }
+
+        std::priority_queue<std::pair<int, VertexId>, std::vector<std::pair<int, VertexId>>, std::greater<>> queue;
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            queue.push({GetPriority(vertex), vertex});
+        }
+        size_t rank = 0;
+        while (!queue.empty()) {
+            const VertexId vertex = queue.top().second;
+            queue.pop();
+            const int priority = GetPriority(vertex);
+            if (!queue.empty() && priority > queue.top().first) {
+                queue.push({priority, vertex});
+                continue;
+            }
+            Contract(vertex);
+            hierarchy_.ranks_[vertex] = rank++;
+        }
+    }
+
+private:
+    void AddEdge(const HierarchyEdge& edge) {
+        const EdgeId edge_id = hierarchy_.AddEdge(edge);
+        out_edges_[edge.from].push_back(edge_id);
+        in_edges_[edge.to].push_back(edge_id);
+    }
+
+    // The cheapest edge to every remaining neighbour, parallel edges are dropped
+    std::vector<EdgeId> GetCheapestEdges(VertexId vertex, const std::vector<std::vector<EdgeId>>& edges,
+                                         bool outgoing) const {
+        std::unordered_map<VertexId, EdgeId> cheapest;
+        for (const EdgeId edge_id : edges[vertex]) {
+            const HierarchyEdge& edge = hierarchy_.edges_[edge_id];
+            const VertexId neighbour = outgoing ? edge.to : edge.from;
+            if (contracted_[neighbour]) {
+                continue;
+            }
+            const auto [it, inserted] = cheapest.emplace(neighbour, edge_id);
+            if (!inserted && edge.weight < hierarchy_.edges_[it->second].weight) {
+                it->second = edge_id;
+            }
+        }
+        std::vector<EdgeId> result;
+        result.reserve(cheapest.size());
+        for (const auto& [neighbour, edge_id] : cheapest) {
+            result.push_back(edge_id);
+        }
+        // Keeps preprocessing independent of the hash map's iteration order
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    std::vector<Shortcut> FindShortcuts(VertexId vertex, size_t max_settled) {
+        const std::vector<EdgeId> in_edges = GetCheapestEdges(vertex, in_edges_, false);
+        const std::vector<EdgeId> out_edges = GetCheapestEdges(vertex, out_edges_, true);
+        std::vector<Shortcut> shortcuts;
+        if (in_edges.empty() || out_edges.empty()) {
+            return shortcuts;
+        }
+        // A witness can only reach targets that have incoming edges from other vertices
+        Weight max_out_weight = ZERO_WEIGHT;
+        size_t target_count = 0;
+        for (const EdgeId edge_id : out_edges) {
+            const HierarchyEdge& edge = hierarchy_.edges_[edge_id];
+            const auto& target_in_edges = in_edges_[edge.to];
+            const bool has_other_in_edges = std::any_of(target_in_edges.begin(), target_in_edges.end(),
+                [this, vertex](EdgeId target_in_edge_id) {
+                    return hierarchy_.edges_[target_in_edge_id].from != vertex;
+                });
+            if (has_other_in_edges) {
+                max_out_weight = std::max(max_out_weight, edge.weight);
+                is_target_[edge.to] = true;
+                ++target_count;
+            }
+        }
+        for (const EdgeId in_edge_id : in_edges) {
+            const HierarchyEdge& in_edge = hierarchy_.edges_[in_edge_id];
+            if (target_count > 0) {
+                FindWitnesses(in_edge.from, vertex, in_edge.weight + max_out_weight, target_count, max_settled);
+            }
+            for (const EdgeId out_edge_id : out_edges) {
+                const HierarchyEdge& out_edge = hierarchy_.edges_[out_edge_id];
+                if (out_edge.to == in_edge.from) {
+                    continue;
+                }
+                const Weight weight = in_edge.weight + out_edge.weight;
+                const auto& witness_weight = witness_weights_[out_edge.to];
+                if (!witness_weight || weight < *witness_weight) {
+                    shortcuts.push_back({in_edge.from, out_edge.to, weight, in_edge_id, out_edge_id});
+                }
+            }
+            ResetWitnesses();
+        }
+        for (const EdgeId edge_id : out_edges) {
+            is_target_[hierarchy_.edges_[edge_id].to] = false;
+        }
+        return shortcuts;
+    }
+
+    // Bounded Dijkstra from source in the remaining graph without the vertex being contracted.
+    // The search ends once all targets are settled; stopping earlier only means
+    // that some unnecessary shortcuts are added.
+    void FindWitnesses(VertexId source, VertexId excluded, Weight max_weight, size_t target_count,
+                       size_t max_settled) {
+        Queue queue;
+        witness_weights_[source] = ZERO_WEIGHT;
+        touched_.push_back(source);
+        queue.push({ZERO_WEIGHT, source});
+        size_t settled = 0;
+        while (!queue.empty() && settled < max_settled) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > *witness_weights_[vertex]) {
+                continue;
+            }
+            if (weight > max_weight) {
+                break;
+            }
+            ++settled;
+            if (is_target_[vertex] && --target_count == 0) {
+                break;
+            }
+            for (const EdgeId edge_id : out_edges_[vertex]) {
+                const HierarchyEdge& edge = hierarchy_.edges_[edge_id];
+                if (edge.to == excluded) {
+                    continue;
+                }
+                const Weight candidate_weight = weight + edge.weight;
+                auto& to_weight = witness_weights_[edge.to];
+                if (!to_weight || candidate_weight < *to_weight) {
+                    if (!to_weight) {
+                        touched_.push_back(edge.to);
+                    }
+                    to_weight = candidate_weight;
+                    queue.push({candidate_weight, edge.to});
+                }
+            }
+        }
+    }
+
+    void ResetWitnesses() {
+        for (const VertexId vertex : touched_) {
+            witness_weights_[vertex].reset();
+        }
+        touched_.clear();
+    }
+
+    int GetPriority(VertexId vertex) {
+        const int removed_edges = static_cast<int>(GetCheapestEdges(vertex, in_edges_, false).size()
+                                                   + GetCheapestEdges(vertex, out_edges_, true).size());
+        const int added_edges = static_cast<int>(FindShortcuts(vertex, PRIORITY_WITNESS_SETTLED).size());
+        return 2 * (added_edges - removed_edges) + contracted_neighbours_[vertex] + levels_[vertex];
+    }
+
+    void Contract(VertexId vertex) {
+        for (const Shortcut& shortcut : FindShortcuts(vertex, MAX_WITNESS_SETTLED)) {
+            AddEdge({shortcut.from, shortcut.to, shortcut.weight, shortcut.first, shortcut.second});
+        }
+        contracted_[vertex] = true;
+        // Edges to contracted vertices are dropped so that the remaining graph stays small
+        auto is_dead = [this](EdgeId edge_id) {
+            const HierarchyEdge& edge = hierarchy_.edges_[edge_id];
+            return contracted_[edge.from] || contracted_[edge.to];
+        };
+        for (const EdgeId edge_id : out_edges_[vertex]) {
+            const VertexId neighbour = hierarchy_.edges_[edge_id].to;
+            if (!contracted_[neighbour]) {
+                ++contracted_neighbours_[neighbour];
+                levels_[neighbour] = std::max(levels_[neighbour], levels_[vertex] + 1);
+                auto& edges = in_edges_[neighbour];
+                edges.erase(std::remove_if(edges.begin(), edges.end(), is_dead), edges.end());
+            }
+        }
+        for (const EdgeId edge_id : in_edges_[vertex]) {
+            const VertexId neighbour = hierarchy_.edges_[edge_id].from;
+            if (!contracted_[neighbour]) {
+                ++contracted_neighbours_[neighbour];
+                levels_[neighbour] = std::max(levels_[neighbour], levels_[vertex] + 1);
+                auto& edges = out_edges_[neighbour];
+                edges.erase(std::remove_if(edges.begin(), edges.end(), is_dead), edges.end());
+            }
+        }
+        out_edges_[vertex].clear();
+        out_edges_[vertex].shrink_to_fit();
+        in_edges_[vertex].clear();
+        in_edges_[vertex].shrink_to_fit();
+    }
+
+    static constexpr size_t MAX_WITNESS_SETTLED = 500;
+    static constexpr size_t PRIORITY_WITNESS_SETTLED = 50;
+    ContractionHierarchy& hierarchy_;
+    size_t vertex_count_;
+    std::vector<std::vector<EdgeId>> out_edges_;
+    std::vector<std::vector<EdgeId>> in_edges_;
+    std::vector<bool> contracted_;
+    std::vector<int> contracted_neighbours_;
+    // Depth of the hierarchy below a vertex, keeps the search spaces shallow
+    std::vector<int> levels_;
+    std::vector<std::optional<Weight>> witness_weights_;
+    std::vector<VertexId> touched_;
+    std::vector<bool> is_target_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : graph_(graph)
+    , ranks_(graph.GetVertexCount())
+{
+    Preprocessor(*this).Run();
+    upward_ = MakeAdjacency(true);
+    downward_ = MakeAdjacency(false);
+}
+
+template <typename Weight>
+EdgeId ContractionHierarchy<Weight>::AddEdge(const HierarchyEdge& edge) {
+    edges_.push_back(edge);
+    return edges_.size() - 1;
+}
+
+template <typename Weight>
+typename ContractionHierarchy<Weight>::Adjacency ContractionHierarchy<Weight>::MakeAdjacency(bool upward) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    Adjacency adjacency;
+    adjacency.offsets.assign(vertex_count + 1, 0);
+    // Upward edges are indexed by their tail, downward ones by their head
+    auto get_vertex = [upward](const HierarchyEdge& edge) {
+        return upward ? edge.from : edge.to;
+    };
+    auto is_included = [this, upward](const HierarchyEdge& edge) {
+        return (ranks_[edge.from] < ranks_[edge.to]) == upward;
+    };
+    for (const HierarchyEdge& edge : edges_) {
+        if (is_included(edge)) {
+            ++adjacency.offsets[get_vertex(edge) + 1];
+        }
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        adjacency.offsets[vertex + 1] += adjacency.offsets[vertex];
+    }
+    adjacency.ids.resize(adjacency.offsets[vertex_count]);
+    std::vector<size_t> positions(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        if (is_included(edges_[edge_id])) {
+            adjacency.ids[positions[get_vertex(edges_[edge_id])]++] = edge_id;
+        }
+    }
+    return adjacency;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::SearchStep(Queue& queue, std::unordered_map<VertexId, Label>& labels,
+                                              const Adjacency& adjacency, const Adjacency& stall_adjacency,
+                                              bool forward) const {
+    const auto [weight, vertex] = queue.top();
+    queue.pop();
+    if (weight > labels.at(vertex).weight) {
+        return;
+    }
+    // Stall-on-demand: a vertex reached suboptimally through a higher-ranked one is not expanded
+    for (size_t i = stall_adjacency.offsets[vertex]; i < stall_adjacency.offsets[vertex + 1]; ++i) {
+        const HierarchyEdge& edge = edges_[stall_adjacency.ids[i]];
+        const auto it = labels.find(forward ? edge.from : edge.to);
+        if (it != labels.end() && it->second.weight + edge.weight < weight) {
+            return;
+        }
+    }
+    for (size_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i) {
+        const EdgeId edge_id = adjacency.ids[i];
+        const HierarchyEdge& edge = edges_[edge_id];
+        const VertexId next = forward ? edge.to : edge.from;
+        const Weight candidate_weight = weight + edge.weight;
+        const auto it = labels.find(next);
+        if (it == labels.end() || candidate_weight < it->second.weight) {
+            labels[next] = Label{candidate_weight, edge_id};
+            queue.push({candidate_weight, next});
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(
+        VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    // Search spaces are small, so per-query hash maps are cheaper than arrays over all vertices
+    std::unordered_map<VertexId, Label> forward_labels{{from, Label{ZERO_WEIGHT, NO_EDGE}}};
+    std::unordered_map<VertexId, Label> backward_labels{{to, Label{ZERO_WEIGHT, NO_EDGE}}};
+    Queue forward_queue;
+    Queue backward_queue;
+    forward_queue.push({ZERO_WEIGHT, from});
+    backward_queue.push({ZERO_WEIGHT, to});
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+    auto update_best = [&](VertexId vertex) {
+        const auto forward_it = forward_labels.find(vertex);
+        const auto backward_it = backward_labels.find(vertex);
+        if (forward_it == forward_labels.end() || backward_it == backward_labels.end()) {
+            return;
+        }
+        const Weight weight = forward_it->second.weight + backward_it->second.weight;
+        if (!best_weight || weight < *best_weight) {
+            best_weight = weight;
+            meeting_vertex = vertex;
+        }
+    };
+    // A direction is finished once its closest unsettled vertex is no closer than the best route
+    auto is_active = [&best_weight](const Queue& queue) {
+        return !queue.empty() && (!best_weight || queue.top().first < *best_weight);
+    };
+
+    while (is_active(forward_queue) || is_active(backward_queue)) {
+        const bool forward = is_active(forward_queue)
+                             && (!is_active(backward_queue) || forward_queue.top().first <= backward_queue.top().first);
+        Queue& queue = forward ? forward_queue : backward_queue;
+        const VertexId vertex = queue.top().second;
+        SearchStep(queue, forward ? forward_labels : backward_labels, forward ? upward_ : downward_,
+                   forward ? downward_ : upward_, forward);
+        update_best(vertex);
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> hierarchy_edges;
+    for (EdgeId edge_id = forward_labels.at(meeting_vertex).prev_edge; edge_id != NO_EDGE;
+         edge_id = forward_labels.at(edges_[edge_id].from).prev_edge) {
+        hierarchy_edges.push_back(edge_id);
+    }
+    std::reverse(hierarchy_edges.begin(), hierarchy_edges.end());
+    for (EdgeId edge_id = backward_labels.at(meeting_vertex).prev_edge; edge_id != NO_EDGE;
+         edge_id = backward_labels.at(edges_[edge_id].to).prev_edge) {
+        hierarchy_edges.push_back(edge_id);
+    }
+
+    std::vector<EdgeId> edges;
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : hierarchy_edges) {
+        UnpackEdge(edge_id, edges);
+    }
+    for (const EdgeId edge_id : edges) {
+        weight += graph_.GetEdge(edge_id).weight;
+    }
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+    std::vector<EdgeId> stack{edge_id};
+    while (!stack.empty()) {
+        const HierarchyEdge& edge = edges_[stack.back()];
+        stack.pop_back();
+        if (edge.second == NO_EDGE) {
+            edges.push_back(edge.first);
+        } else {
+            stack.push_back(edge.second);
+            stack.push_back(edge.first);
+        }
+    }
+}
+
+}  // namespace graph
@@ -0,0 +1,29 @@
+#pragma once
+
+// SIMD code paths are compiled with per-function target attributes and picked at runtime,
+// so the binary still runs on CPUs without the extensions
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_FEATURES_X86 1
+#endif
+
+namespace cpu {
+
+inline bool HasSse2() {
+#ifdef CPU_FEATURES_X86
+    static const bool has_sse2 = __builtin_cpu_supports("sse2");
+    return has_sse2;
+#else
+    return false;
+#endif
+}
+
+inline bool HasAvx2() {
+#ifdef CPU_FEATURES_X86
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+#else
+    return false;
+#endif
+}
+
+}  // namespace cpu
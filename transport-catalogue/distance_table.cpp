@@ -0,0 +1,76 @@
+#include "distance_table.h"
+
+namespace transport_catalogue {
+
+void DistanceTable::Set(uint32_t from, uint32_t to, int distance) {
+    // keeps the load factor at most one half so that probe runs stay short
+    if ((used_slots_ + 2) * 2 > slots_.size()) {
+        Grow();
+    }
+    Slot& direct = FindSlot(GetKey(from, to));
+    if (direct.key == EMPTY_KEY) {
+        direct.key = GetKey(from, to);
+        ++used_slots_;
+    }
+    direct.is_explicit = true;
+    direct.distance = distance;
+
+    if (from == to) {
+        return;
+    }
+    Slot& reverse = FindSlot(GetKey(to, from));
+    if (reverse.key == EMPTY_KEY) {
+        reverse.key = GetKey(to, from);
+        ++used_slots_;
+    }
+    if (!reverse.is_explicit) {
+        reverse.distance = distance;
+    }
+}
+
+std::optional<int> DistanceTable::Find(uint32_t from, uint32_t to) const {
+    if (slots_.empty()) {
+        return std::nullopt;
+    }
+    const uint64_t key = GetKey(from, to);
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = GetSlotIndex(key); ; i = (i + 1) & mask) {
+        if (slots_[i].key == key) {
+            return slots_[i].distance;
+        }
+        if (slots_[i].key == EMPTY_KEY) {
+            return std::nullopt;
+        }
+    }
+}
+
+uint64_t DistanceTable::GetKey(uint32_t from, uint32_t to) {
+    return static_cast<uint64_t>(from) << 32 | to;
+}
+
+size_t DistanceTable::GetSlotIndex(uint64_t key) const {
+    // Fibonacci hashing, the upper half of the product mixes both stop ids
+    const uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(hash >> 32) & (slots_.size() - 1);
+}
+
+DistanceTable::Slot& DistanceTable::FindSlot(uint64_t key) {
+    const size_t mask = slots_.size() - 1;
+    size_t i = GetSlotIndex(key);
+    while (slots_[i].key != key && slots_[i].key != EMPTY_KEY) {
+        i = (i + 1) & mask;
+    }
+    return slots_[i];
+}
+
+void DistanceTable::Grow() {
+    std::vector<Slot> old_slots(slots_.empty() ? MIN_CAPACITY : slots_.size() * 2);
+    old_slots.swap(slots_);
+    for (const Slot& slot : old_slots) {
+        if (slot.key != EMPTY_KEY) {
+            FindSlot(slot.key) = slot;
+        }
+    }
+}
+
+} // namespace transport_catalogue
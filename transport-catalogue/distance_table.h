@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace transport_catalogue {
+
+// Road distances between stops keyed by the pair of dense stop ids.
+// An open-addressing table with linear probing: a lookup is one hash and a short run
+// over adjacent slots. Setting a distance also fills in the reverse direction unless
+// it was given explicitly, so a lookup never has to try the reverse pair.
+class DistanceTable {
+public:
+    void Set(uint32_t from, uint32_t to, int distance);
+    std::optional<int> Find(uint32_t from, uint32_t to) const;
+
+    // Calls func(from, to, distance) for every explicitly set distance
+    template <typename Func>
+    void ForEach(Func func) const {
+        for (const Slot& slot : slots_) {
+            if (slot.key != EMPTY_KEY && slot.is_explicit) {
+                func(static_cast<uint32_t>(slot.key >> 32), static_cast<uint32_t>(slot.key), slot.distance);
+            }
+        }
+    }
+
+private:
+    static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    struct Slot {
+        uint64_t key = EMPTY_KEY;
+        int distance = 0;
+        // false for a distance copied from the reverse direction
+        bool is_explicit = false;
+    };
+
+    static uint64_t GetKey(uint32_t from, uint32_t to);
+    size_t GetSlotIndex(uint64_t key) const;
+    // Returns the slot holding key or the empty slot where it should be inserted
+    Slot& FindSlot(uint64_t key);
+    void Grow();
+
+    std::vector<Slot> slots_;
+    size_t used_slots_ = 0;
+};
+
+} // namespace transport_catalogue
@@ -2,6 +2,7 @@
 
 #include "geo.h"
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <set>
@@ -10,12 +11,16 @@
 struct Stop {
     std::string name_of_stop;
     geo::Coordinates coordinates;
+    // Dense index of the stop in the order of addition to the catalogue
+    uint32_t id{};
 };
 
 struct Bus {
     std::string route;
     std::vector<Stop*> stops_on_route;
     bool is_round;
+    // Dense index of the bus in the order of addition to the catalogue
+    uint32_t id{};
 };
 
 struct StopInfo {
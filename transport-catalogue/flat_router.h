@@ -0,0 +1,252 @@
+#pragma once
+
+#include "graph.h"
+#include "min_plus.h"
+#include "router.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// All-pairs router with the same results as Router, but storing the matrix in two contiguous
+// row-major buffers: weights with a sentinel for unreachable pairs and 32-bit predecessor edge ids.
+// A cell takes sizeof(Weight) + 4 bytes instead of a padded optional<RouteInternalData>.
+//
+// The relaxation is blocked: pivots are taken PIVOT_BLOCK at a time and every row is swept
+// through the whole block one column tile at a time, so a tile stays in L1 for all the pivots
+// of the block and the matrix is streamed from memory once per block instead of once per pivot.
+// Each cell still sees exactly the same sequence of operations as in the textbook triple loop,
+// so weights and predecessors are bit-identical to Router. For double weights the tiles are
+// relaxed by the vectorized min-plus kernel.
+//
+// Rows are independent within a pivot block, so with thread_count > 1 they are spread over
+// a thread pool with one barrier per block; the tables do not depend on the thread count.
+template <typename Weight>
+class FlatRouter final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RoutingEngine<Weight>::RouteInfo;
+    using PrevEdgeId = uint32_t;
+
+    static constexpr Weight UNREACHABLE = std::numeric_limits<Weight>::has_infinity
+                                              ? std::numeric_limits<Weight>::infinity()
+                                              : std::numeric_limits<Weight>::max();
+    static constexpr PrevEdgeId NO_EDGE = min_plus::NO_EDGE;
+
+    // Read-only view of the V x V weight and predecessor matrices
+    struct Tables {
+        const Weight* weights = nullptr;
+        const PrevEdgeId* prev_edges = nullptr;
+    };
+
+    explicit FlatRouter(const Graph& graph, size_t thread_count = 1);
+    // Serves routes from tables computed earlier for the same graph, e.g. mapped from a file.
+    // The tables are not copied and must outlive the router.
+    FlatRouter(const Graph& graph, Tables tables);
+
+    Tables GetTables() const;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    void InitializeRoutesInternalData(const Graph& graph) {
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            weights_[Index(vertex, vertex)] = ZERO_WEIGHT;
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                const auto& edge = graph.GetEdge(edge_id);
+                if (edge.weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                const size_t index = Index(vertex, edge.to);
+                if (weights_[index] == UNREACHABLE || weights_[index] > edge.weight) {
+                    weights_[index] = edge.weight;
+                    prev_edges_[index] = static_cast<PrevEdgeId>(edge_id);
+                }
+            }
+        }
+    }
+
+    // Rows of the current pivot block, each taken at the moment its pivot comes in the
+    // textbook order, i.e. with the preceding pivots of the block already applied
+    struct PivotBlock {
+        VertexId begin = 0;
+        size_t size = 0;
+        std::vector<Weight> weights;
+        std::vector<PrevEdgeId> prev_edges;
+    };
+
+    void SnapshotPivotRows(VertexId block_begin, VertexId block_end, PivotBlock& block) const {
+        block.begin = block_begin;
+        block.size = block_end - block_begin;
+        block.weights.assign(weights_.begin() + Index(block_begin, 0), weights_.begin() + Index(block_end, 0));
+        block.prev_edges.assign(prev_edges_.begin() + Index(block_begin, 0),
+                                prev_edges_.begin() + Index(block_end, 0));
+        for (size_t pivot = 1; pivot < block.size; ++pivot) {
+            RelaxRowThroughPivots(&block.weights[pivot * vertex_count_], &block.prev_edges[pivot * vertex_count_],
+                                  block, pivot);
+        }
+    }
+
+    // Applies the first pivot_count pivots of the block to the row
+    void RelaxRowThroughPivots(Weight* weights_row, PrevEdgeId* prev_edges_row, const PivotBlock& block,
+                               size_t pivot_count) const {
+        // The row's cells in the block columns are the only ones that feed later pivots, so they
+        // are advanced first to learn the route to each pivot vertex at the time it is applied
+        Weight block_weights[PIVOT_BLOCK];
+        PrevEdgeId block_prev_edges[PIVOT_BLOCK];
+        std::copy(weights_row + block.begin, weights_row + block.begin + block.size, block_weights);
+        std::copy(prev_edges_row + block.begin, prev_edges_row + block.begin + block.size, block_prev_edges);
+
+        Weight weights_from[PIVOT_BLOCK];
+        PrevEdgeId prev_edges_from[PIVOT_BLOCK];
+        for (size_t pivot = 0; pivot < pivot_count; ++pivot) {
+            weights_from[pivot] = block_weights[pivot];
+            prev_edges_from[pivot] = block_prev_edges[pivot];
+            if (weights_from[pivot] != UNREACHABLE) {
+                RelaxCells(weights_from[pivot], prev_edges_from[pivot],
+                           &block.weights[pivot * vertex_count_ + block.begin],
+                           &block.prev_edges[pivot * vertex_count_ + block.begin],
+                           block_weights, block_prev_edges, block.size);
+            }
+        }
+
+        for (size_t column_begin = 0; column_begin < vertex_count_; column_begin += COLUMN_TILE) {
+            const size_t column_count = std::min(COLUMN_TILE, vertex_count_ - column_begin);
+            for (size_t pivot = 0; pivot < pivot_count; ++pivot) {
+                if (weights_from[pivot] == UNREACHABLE) {
+                    continue;
+                }
+                RelaxCells(weights_from[pivot], prev_edges_from[pivot],
+                           &block.weights[pivot * vertex_count_ + column_begin],
+                           &block.prev_edges[pivot * vertex_count_ + column_begin],
+                           weights_row + column_begin, prev_edges_row + column_begin, column_count);
+            }
+        }
+    }
+
+    void RelaxRoutesInternalDataThroughBlock(VertexId block_begin, VertexId block_end, PivotBlock& block,
+                                             parallel::ThreadPool& pool) {
+        SnapshotPivotRows(block_begin, block_end, block);
+        pool.ParallelFor(vertex_count_, ROWS_PER_TASK, [this, &block](size_t rows_begin, size_t rows_end) {
+            for (VertexId vertex_from = rows_begin; vertex_from < rows_end; ++vertex_from) {
+                RelaxRowThroughPivots(&weights_[Index(vertex_from, 0)], &prev_edges_[Index(vertex_from, 0)],
+                                      block, block.size);
+            }
+        });
+    }
+
+    static void RelaxCells(Weight weight_from, PrevEdgeId prev_edge_from,
+                           const Weight* weights_through, const PrevEdgeId* prev_edges_through,
+                           Weight* weights_row, PrevEdgeId* prev_edges_row, size_t count) {
+        if constexpr (std::is_same_v<Weight, double>) {
+            min_plus::RelaxRow(weight_from, prev_edge_from, weights_through, prev_edges_through,
+                               weights_row, prev_edges_row, count);
+        } else {
+            for (size_t column = 0; column < count; ++column) {
+                if (weights_through[column] == UNREACHABLE) {
+                    continue;
+                }
+                const Weight candidate_weight = weight_from + weights_through[column];
+                if (weights_row[column] == UNREACHABLE || candidate_weight < weights_row[column]) {
+                    weights_row[column] = candidate_weight;
+                    prev_edges_row[column] = prev_edges_through[column] != NO_EDGE
+                                                 ? prev_edges_through[column]
+                                                 : prev_edge_from;
+                }
+            }
+        }
+    }
+
+    size_t Index(VertexId from, VertexId to) const {
+        return from * vertex_count_ + to;
+    }
+
+    // A tile of 256 double weights and predecessors takes 3 KB, the 64 pivot rows of a block
+    // restricted to one tile take 192 KB and stay in L2
+    static constexpr size_t PIVOT_BLOCK = 64;
+    static constexpr size_t COLUMN_TILE = 256;
+    static constexpr size_t ROWS_PER_TASK = 16;
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    size_t vertex_count_;
+    std::vector<Weight> weights_;
+    std::vector<PrevEdgeId> prev_edges_;
+    // Point either to the vectors above or to external tables
+    Tables tables_;
+};
+
+template <typename Weight>
+FlatRouter<Weight>::FlatRouter(const Graph& graph, size_t thread_count)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+{
+    if (graph.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for 32-bit edge ids");
+    }
+    weights_.assign(vertex_count_ * vertex_count_, UNREACHABLE);
+    prev_edges_.assign(vertex_count_ * vertex_count_, NO_EDGE);
+
+    InitializeRoutesInternalData(graph);
+
+    parallel::ThreadPool pool(thread_count);
+    PivotBlock block;
+    for (VertexId block_begin = 0; block_begin < vertex_count_; block_begin += PIVOT_BLOCK) {
+        RelaxRoutesInternalDataThroughBlock(block_begin, std::min(block_begin + PIVOT_BLOCK, vertex_count_),
+                                            block, pool);
+    }
+    tables_ = {weights_.data(), prev_edges_.data()};
+}
+
+template <typename Weight>
+FlatRouter<Weight>::FlatRouter(const Graph& graph, Tables tables)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , tables_(tables)
+{
+}
+
+template <typename Weight>
+typename FlatRouter<Weight>::Tables FlatRouter<Weight>::GetTables() const {
+    return tables_;
+}
+
+template <typename Weight>
+std::optional<typename FlatRouter<Weight>::RouteInfo> FlatRouter<Weight>::BuildRoute(VertexId from,
+                                                                                     VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const Weight weight = tables_.weights[Index(from, to)];
+    if (weight == UNREACHABLE) {
+        return std::nullopt;
+    }
+    // The tables may be mapped from a file, so every predecessor is checked before it is followed:
+    // it must be an edge of the graph entering the current vertex, and a route visits a vertex once
+    std::vector<EdgeId> edges;
+    VertexId vertex = to;
+    for (PrevEdgeId edge_id = tables_.prev_edges[Index(from, to)];
+         edge_id != NO_EDGE;
+         edge_id = tables_.prev_edges[Index(from, vertex)])
+    {
+        if (edge_id >= graph_.GetEdgeCount() || graph_.GetEdge(edge_id).to != vertex || edges.size() >= vertex_count_) {
+            throw std::out_of_range("Broken predecessor edge in the route tables");
+        }
+        edges.push_back(edge_id);
+        vertex = graph_.GetEdge(edge_id).from;
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
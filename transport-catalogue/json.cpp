@@ -1,5 +1,11 @@
 #include "json.h"
+#include "json_scan.h"
+
+#include <charconv>
+#include <deque>
 #include <stdexcept>
+#include <string_view>
+#include <unordered_set>
 #include <utility>
 
 namespace json {
@@ -124,6 +130,10 @@ const Node& Document::GetRoot() const {
     return root_;
 }
 
+Node& Document::GetRoot() {
+    return root_;
+}
+
 bool operator==(const Document& lhs, const Document& rhs) {
     return lhs.GetRoot() == rhs.GetRoot();
 }
@@ -252,6 +262,25 @@ Node LoadNull(std::istream& input) {
     }
 }
 
+// Converts a number already checked against the JSON grammar
+Node ConvertNumber(std::string_view parsed_num, bool is_int) {
+    const char* first = parsed_num.data();
+    const char* last = first + parsed_num.size();
+    if (is_int) {
+        int value;
+        if (const auto [ptr, ec] = std::from_chars(first, last, value); ec == std::errc{}) {
+            return value;
+        }
+        // In case of overflow the code below converts the number to a double
+    }
+    // from_chars rounds correctly, so the result is the same as the one of std::stod
+    double value;
+    if (const auto [ptr, ec] = std::from_chars(first, last, value); ec != std::errc{} || ptr != last) {
+        throw ParsingError("Failed to convert "s + std::string(parsed_num) + " to number"s);
+    }
+    return value;
+}
+
 Node LoadNumber(std::istream& input) {
     std::string parsed_num;
 
@@ -302,20 +331,7 @@ Node LoadNumber(std::istream& input) {
         is_int = false;
     }
 
-    try {
-        if (is_int) {
-            // try to convert the string to an int
-            try {
-                return std::stoi(parsed_num);
-            } catch (...) {
-            // In case of failure, such as overflow,
-            // the code below will attempt to convert the string to a double
-            }
-        }
-        return std::stod(parsed_num);
-    } catch (...) {
-        throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
-    }
+    return ConvertNumber(parsed_num, is_int);
 }
 
 Node LoadNode(std::istream& input) {
@@ -345,6 +361,302 @@ Node LoadNode(std::istream& input) {
     }
 }
 
+// Scans the tokens of a contiguous buffer with a pointer instead of going through a stream.
+// Accepts the same tokens as the istream functions above and reports the same errors
+class BufferScanner {
+protected:
+    explicit BufferScanner(std::string_view input)
+        : pos_(input.data())
+        , end_(input.data() + input.size()) {
+    }
+
+    static bool IsSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+    }
+
+    static bool IsDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static bool IsAlpha(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    // Skips whitespace and reads the next character like input >> c
+    bool ReadChar(char& c) {
+        // most tokens are not preceded by whitespace, the vector scan pays off on indentation
+        if (pos_ != end_ && IsSpace(*pos_)) {
+            pos_ += scan::SkipWhitespace(pos_, end_ - pos_);
+        }
+        if (pos_ == end_) {
+            return false;
+        }
+        c = *pos_++;
+        return true;
+    }
+
+    std::string_view LoadLiteral() {
+        const char* begin = pos_;
+        while (pos_ != end_ && IsAlpha(*pos_)) {
+            ++pos_;
+        }
+        return {begin, static_cast<size_t>(pos_ - begin)};
+    }
+
+    // Returns a view into the input when the string has no escapes,
+    // otherwise unescapes it into buffer and returns a view of it
+    std::string_view ParseStringView(std::string& buffer) {
+        const char* begin = pos_;
+        const size_t run_size = scan::FindStringSpecial(pos_, end_ - pos_);
+        if (run_size != static_cast<size_t>(end_ - pos_) && pos_[run_size] == '"') {
+            pos_ += run_size + 1;
+            return {begin, run_size};
+        }
+        buffer = ParseString();
+        return buffer;
+    }
+
+    std::string ParseString() {
+        std::string s;
+        while (true) {
+            // copies the run of plain characters at once
+            const size_t run_size = scan::FindStringSpecial(pos_, end_ - pos_);
+            s.append(pos_, run_size);
+            pos_ += run_size;
+            if (pos_ == end_) {
+                throw ParsingError("String parsing error");
+            }
+            const char ch = *pos_++;
+            if (ch == '"') {
+                break;
+            } else if (ch == '\\') {
+                if (pos_ == end_) {
+                    throw ParsingError("String parsing error");
+                }
+                const char escaped_char = *pos_++;
+                switch (escaped_char) {
+                    case 'n':
+                        s.push_back('\n');
+                        break;
+                    case 't':
+                        s.push_back('\t');
+                        break;
+                    case 'r':
+                        s.push_back('\r');
+                        break;
+                    case '"':
+                        s.push_back('"');
+                        break;
+                    case '\\':
+                        s.push_back('\\');
+                        break;
+                    default:
+                        throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+                }
+            } else if (ch == '\n' || ch == '\r') {
+                throw ParsingError("Unexpected end of line"s);
+            } else {
+                // other control characters are kept as they are
+                s.push_back(ch);
+            }
+        }
+
+        return s;
+    }
+
+    Node LoadBool() {
+        const auto s = LoadLiteral();
+        if (s == "true"sv) {
+            return Node{true};
+        } else if (s == "false"sv) {
+            return Node{false};
+        } else {
+            throw ParsingError("Failed to parse '"s + std::string(s) + "' as bool"s);
+        }
+    }
+
+    Node LoadNull() {
+        if (auto literal = LoadLiteral(); literal == "null"sv) {
+            return Node{nullptr};
+        } else {
+            throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
+        }
+    }
+
+    Node LoadNumber() {
+        const char* begin = pos_;
+
+        // Skips one or more digits
+        auto read_digits = [this] {
+            if (pos_ == end_ || !IsDigit(*pos_)) {
+                throw ParsingError("A digit is expected"s);
+            }
+            while (pos_ != end_ && IsDigit(*pos_)) {
+                ++pos_;
+            }
+        };
+
+        if (pos_ != end_ && *pos_ == '-') {
+            ++pos_;
+        }
+        // Parse the integer part of the number
+        if (pos_ != end_ && *pos_ == '0') {
+            ++pos_;
+        // No other digits can follow 0 in JSON
+        } else {
+            read_digits();
+        }
+
+        bool is_int = true;
+        // Parse the fractional part of the number
+        if (pos_ != end_ && *pos_ == '.') {
+            ++pos_;
+            read_digits();
+            is_int = false;
+        }
+
+        // Parse the exponential part of the number
+        if (pos_ != end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+            ++pos_;
+            if (pos_ != end_ && (*pos_ == '+' || *pos_ == '-')) {
+                ++pos_;
+            }
+            read_digits();
+            is_int = false;
+        }
+
+        return ConvertNumber(std::string_view(begin, pos_ - begin), is_int);
+    }
+
+    const char* pos_;
+    const char* end_;
+};
+
+// Walks the same grammar as the istream functions above and reports the same errors,
+// but passes every value to the handler instead of building nodes
+class EventParser : private BufferScanner {
+public:
+    EventParser(std::string_view input, Handler& handler)
+        : BufferScanner(input)
+        , handler_(handler) {
+    }
+
+    void ParseNode() {
+        char c;
+        if (!ReadChar(c)) {
+            throw ParsingError("Unexpected EOF"s);
+        }
+        switch (c) {
+            case '[':
+                ParseArray();
+                break;
+            case '{':
+                ParseDict();
+                break;
+            case '"':
+                handler_.String(ParseStringView(string_buffer_));
+                break;
+            case 't':
+                [[fallthrough]];
+            case 'f':
+                --pos_;
+                handler_.Bool(LoadBool().AsBool());
+                break;
+            case 'n':
+                --pos_;
+                LoadNull();
+                handler_.Null();
+                break;
+            default: {
+                --pos_;
+                const Node number = LoadNumber();
+                if (number.IsInt()) {
+                    handler_.Int(number.AsInt());
+                } else {
+                    handler_.Double(number.AsDouble());
+                }
+            }
+        }
+    }
+
+private:
+    void ParseArray() {
+        handler_.StartArray();
+
+        char c;
+        bool is_closed = false;
+        while (ReadChar(c)) {
+            if (c == ']') {
+                is_closed = true;
+                break;
+            }
+            if (c != ',') {
+                --pos_;
+            }
+            ParseNode();
+        }
+        if (!is_closed) {
+            throw ParsingError("Array parsing error"s);
+        }
+        handler_.EndArray();
+    }
+
+    void ParseDict() {
+        handler_.StartDict();
+        // the keys of the enclosing dicts stay below, their sets are reused by later dicts
+        if (dict_keys_.size() == depth_) {
+            dict_keys_.emplace_back();
+        }
+        DictKeys& keys = dict_keys_[depth_++];
+
+        char c;
+        bool is_closed = false;
+        while (ReadChar(c)) {
+            if (c == '}') {
+                is_closed = true;
+                break;
+            }
+            if (c == '"') {
+                std::string_view key = ParseStringView(string_buffer_);
+                if (ReadChar(c) && c == ':') {
+                    // keys with escapes are not in the input, they are kept until the dict is over
+                    if (key.data() == string_buffer_.data()) {
+                        key = keys.unescaped_keys.emplace_back(key);
+                    }
+                    if (!keys.keys.insert(key).second) {
+                        throw ParsingError("Duplicate key '"s + std::string(key) + "' have been found");
+                    }
+                    handler_.Key(key);
+                    ParseNode();
+                } else {
+                    throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                }
+            } else if (c != ',') {
+                throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+            }
+        }
+        if (!is_closed) {
+            throw ParsingError("Dictionary parsing error"s);
+        }
+        keys.keys.clear();
+        keys.unescaped_keys.clear();
+        --depth_;
+        handler_.EndDict();
+    }
+
+    // Keys seen so far in a dict, to report duplicates
+    struct DictKeys {
+        std::unordered_set<std::string_view> keys;
+        std::deque<std::string> unescaped_keys;
+    };
+
+    Handler& handler_;
+    std::string string_buffer_;
+    // One entry for every open dict
+    std::deque<DictKeys> dict_keys_;
+    size_t depth_ = 0;
+};
+
 struct PrintContext {
     std::ostream& out;
     int indent_step = 4;
@@ -368,31 +680,60 @@ void PrintValue(const Value& value, const PrintContext& ctx) {
     ctx.out << value;
 }
 
-void PrintString(const std::string& value, std::ostream& out) {
-    out.put('"');
-    for (const char c : value) {
+void Put(std::ostream& out, char c) {
+    out.put(c);
+}
+
+void Put(OutputBuffer& out, char c) {
+    out.Put(c);
+}
+
+void Write(std::ostream& out, std::string_view text) {
+    out.write(text.data(), text.size());
+}
+
+void Write(OutputBuffer& out, std::string_view text) {
+    out.Write(text);
+}
+
+template <typename Output>
+void PrintString(std::string_view value, Output& out) {
+    Put(out, '"');
+    const char* data = value.data();
+    size_t size = value.size();
+    while (size != 0) {
+        // writes the run of characters that need no escaping at once
+        const size_t run_size = scan::FindStringSpecial(data, size);
+        Write(out, {data, run_size});
+        data += run_size;
+        size -= run_size;
+        if (size == 0) {
+            break;
+        }
+        const char c = *data++;
+        --size;
         switch (c) {
             case '\r':
-                out << "\\r"sv;
+                Write(out, "\\r"sv);
                 break;
             case '\n':
-                out << "\\n"sv;
+                Write(out, "\\n"sv);
                 break;
             case '\t':
-                out << "\\t"sv;
+                Write(out, "\\t"sv);
                 break;
             case '"':
                 // The characters " and \ are output as \" and \\, respectively
                 [[fallthrough]];
             case '\\':
-                out.put('\\');
+                Put(out, '\\');
                 [[fallthrough]];
             default:
-                out.put(c);
+                Put(out, c);
                 break;
         }
     }
-    out.put('"');
+    Put(out, '"');
 }
 
 template <>
@@ -466,8 +807,185 @@ Document Load(std::istream& input) {
     return Document{LoadNode(input)};
 }
 
+void Parse(std::string_view input, Handler& handler) {
+    EventParser(input, handler).ParseNode();
+}
+
 void Print(const Document& doc, std::ostream& output) {
     PrintNode(doc.GetRoot(), PrintContext{output});
 }
 
+OutputBuffer::OutputBuffer(std::ostream& output)
+    : output_(output) {
+    buffer_.reserve(BLOCK_SIZE);
+}
+
+OutputBuffer::~OutputBuffer() {
+    Flush();
+}
+
+void OutputBuffer::Put(char c) {
+    buffer_.push_back(c);
+    FlushFullBlock();
+}
+
+void OutputBuffer::Write(std::string_view text) {
+    buffer_.append(text);
+    FlushFullBlock();
+}
+
+void OutputBuffer::WriteInt(int value) {
+    char chars[16];
+    const auto result = std::to_chars(chars, chars + sizeof(chars), value);
+    Write({chars, static_cast<size_t>(result.ptr - chars)});
+}
+
+void OutputBuffer::WriteDouble(double value) {
+    char chars[32];
+    const auto result = std::to_chars(chars, chars + sizeof(chars), value);
+    Write({chars, static_cast<size_t>(result.ptr - chars)});
+}
+
+void OutputBuffer::WriteDefaultDouble(double value) {
+    char chars[32];
+    const auto result = std::to_chars(chars, chars + sizeof(chars), value, std::chars_format::general, 6);
+    Write({chars, static_cast<size_t>(result.ptr - chars)});
+}
+
+void OutputBuffer::Flush() {
+    output_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+}
+
+void OutputBuffer::FlushFullBlock() {
+    if (buffer_.size() >= BLOCK_SIZE) {
+        Flush();
+    }
+}
+
+Writer::Writer(std::ostream& output, PrintMode mode)
+    : output_(output)
+    , mode_(mode) {
+}
+
+void Writer::StartDict() {
+    StartLevel(true);
+}
+
+void Writer::Key(std::string_view key) {
+    using namespace std::literals;
+    if (levels_.empty() || !levels_.back().is_dict || has_key_) {
+        throw std::logic_error("Key() outside a dict"s);
+    }
+    WriteSeparator(levels_.back());
+    PrintString(key, output_);
+    output_.Write(mode_ == PrintMode::PRETTY ? ": "sv : ":"sv);
+    has_key_ = true;
+}
+
+void Writer::EndDict() {
+    EndLevel(true);
+}
+
+void Writer::StartArray() {
+    StartLevel(false);
+}
+
+void Writer::EndArray() {
+    EndLevel(false);
+}
+
+void Writer::String(std::string_view value) {
+    BeginValue();
+    PrintString(value, output_);
+}
+
+void Writer::Int(int value) {
+    BeginValue();
+    output_.WriteInt(value);
+}
+
+void Writer::Double(double value) {
+    BeginValue();
+    if (mode_ == PrintMode::PRETTY) {
+        output_.WriteDefaultDouble(value);
+    } else {
+        output_.WriteDouble(value);
+    }
+}
+
+void Writer::Bool(bool value) {
+    using namespace std::literals;
+    BeginValue();
+    output_.Write(value ? "true"sv : "false"sv);
+}
+
+void Writer::Null() {
+    using namespace std::literals;
+    BeginValue();
+    output_.Write("null"sv);
+}
+
+void Writer::BeginValue() {
+    using namespace std::literals;
+    if (levels_.empty()) {
+        if (is_done_) {
+            throw std::logic_error("The document is already written"s);
+        }
+        is_done_ = true;
+    } else if (levels_.back().is_dict) {
+        if (!has_key_) {
+            throw std::logic_error("A dict value without a key"s);
+        }
+        has_key_ = false;
+    } else {
+        WriteSeparator(levels_.back());
+    }
+}
+
+void Writer::WriteSeparator(Level& level) {
+    if (!level.is_empty) {
+        output_.Put(',');
+        if (mode_ == PrintMode::PRETTY) {
+            output_.Put('\n');
+        }
+    }
+    level.is_empty = false;
+    WriteIndent();
+}
+
+void Writer::WriteIndent() {
+    if (mode_ == PrintMode::PRETTY) {
+        for (size_t i = 0; i < levels_.size() * 4; ++i) {
+            output_.Put(' ');
+        }
+    }
+}
+
+void Writer::StartLevel(bool is_dict) {
+    BeginValue();
+    output_.Put(is_dict ? '{' : '[');
+    if (mode_ == PrintMode::PRETTY) {
+        output_.Put('\n');
+    }
+    levels_.push_back({is_dict});
+}
+
+void Writer::EndLevel(bool is_dict) {
+    using namespace std::literals;
+    if (levels_.empty() || levels_.back().is_dict != is_dict || has_key_) {
+        throw std::logic_error(is_dict ? "EndDict() outside a dict"s : "EndArray() outside an array"s);
+    }
+    levels_.pop_back();
+    // an empty container still gets the line Print gives it
+    if (mode_ == PrintMode::PRETTY) {
+        output_.Put('\n');
+        WriteIndent();
+    }
+    output_.Put(is_dict ? '}' : ']');
+    if (levels_.empty()) {
+        output_.Flush();
+    }
+}
+
 }  // namespace json
\ No newline at end of file
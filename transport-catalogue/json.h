@@ -3,6 +3,7 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -59,6 +60,7 @@ class Document {
 public:
     explicit Document(Node root);
     const Node& GetRoot() const;
+    Node& GetRoot();
 
 private:
     Node root_;
@@ -67,7 +69,105 @@ private:
 bool operator==(const Document& lhs, const Document& rhs);
 bool operator!=(const Document& lhs, const Document& rhs);
 
+// Receives the values of a document from Parse in the order they appear in the text.
+// Key and String arguments point into the parsed text when it has no escapes,
+// otherwise they only live until the call returns
+class Handler {
+public:
+    virtual ~Handler() = default;
+
+    virtual void StartDict() = 0;
+    virtual void Key(std::string_view key) = 0;
+    virtual void EndDict() = 0;
+    virtual void StartArray() = 0;
+    virtual void EndArray() = 0;
+    virtual void String(std::string_view value) = 0;
+    virtual void Int(int value) = 0;
+    virtual void Double(double value) = 0;
+    virtual void Bool(bool value) = 0;
+    virtual void Null() = 0;
+};
+
 Document Load(std::istream& input);
+// Walks a document held in memory without building nodes. Accepts the same documents and
+// throws the same errors as Load, the handler may already have got a part of the values then
+void Parse(std::string_view input, Handler& handler);
+
 void Print(const Document& doc, std::ostream& output);
 
+enum class PrintMode {
+    // Every value on its own line indented by 4 spaces, numbers as the stream formats them
+    PRETTY,
+    // No whitespace between the tokens and the shortest text that reads back as the same number
+    COMPACT,
+};
+
+// Collects text and passes it to the stream in large blocks, the rest goes out in Flush
+// or in the destructor
+class OutputBuffer {
+public:
+    explicit OutputBuffer(std::ostream& output);
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+    ~OutputBuffer();
+
+    void Put(char c);
+    void Write(std::string_view text);
+    void WriteInt(int value);
+    // The shortest text that reads back as the same value
+    void WriteDouble(double value);
+    // The text an ostream with the default format gives, 6 significant digits
+    void WriteDefaultDouble(double value);
+    void Flush();
+
+private:
+    static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+    void FlushFullBlock();
+
+    std::ostream& output_;
+    std::string buffer_;
+};
+
+// Writes a document to the stream as its values come, without building nodes. The text
+// is passed on in blocks, the rest when the root dict or array is closed or in the destructor.
+// Keys are written in the order they are given, so the text is the same as Print gives to
+// a stream with the default format only when they come sorted.
+// Throws std::logic_error when an event is out of place
+class Writer final : public Handler {
+public:
+    explicit Writer(std::ostream& output, PrintMode mode = PrintMode::PRETTY);
+
+    void StartDict() override;
+    void Key(std::string_view key) override;
+    void EndDict() override;
+    void StartArray() override;
+    void EndArray() override;
+    void String(std::string_view value) override;
+    void Int(int value) override;
+    void Double(double value) override;
+    void Bool(bool value) override;
+    void Null() override;
+
+private:
+    struct Level {
+        bool is_dict;
+        bool is_empty = true;
+    };
+
+    // Writes what goes before a value: the separator of an array item, nothing after a key
+    void BeginValue();
+    void WriteSeparator(Level& level);
+    void WriteIndent();
+    void StartLevel(bool is_dict);
+    void EndLevel(bool is_dict);
+
+    OutputBuffer output_;
+    PrintMode mode_;
+    // The dicts and arrays the next value goes into
+    std::vector<Level> levels_;
+    bool has_key_ = false;
+    bool is_done_ = false;
+};
+
 }  // namespace json
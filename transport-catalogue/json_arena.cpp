@@ -0,0 +1,281 @@
+#include "json_arena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+using namespace std::literals;
+
+namespace json::arena {
+
+bool Node::IsNull() const {
+    return type_ == Type::NULL_VALUE;
+}
+
+bool Node::IsBool() const {
+    return type_ == Type::BOOL;
+}
+
+bool Node::IsInt() const {
+    return type_ == Type::INT;
+}
+
+bool Node::IsPureDouble() const {
+    return type_ == Type::DOUBLE;
+}
+
+bool Node::IsDouble() const {
+    return IsInt() || IsPureDouble();
+}
+
+bool Node::IsString() const {
+    return type_ == Type::STRING;
+}
+
+bool Node::IsArray() const {
+    return type_ == Type::ARRAY;
+}
+
+bool Node::IsDict() const {
+    return type_ == Type::DICT;
+}
+
+bool Node::AsBool() const {
+    if (!IsBool()) {
+        throw std::logic_error("Not a bool"s);
+    }
+    return bool_;
+}
+
+int Node::AsInt() const {
+    if (!IsInt()) {
+        throw std::logic_error("Not an int"s);
+    }
+    return int_;
+}
+
+double Node::AsDouble() const {
+    if (!IsDouble()) {
+        throw std::logic_error("Not a double"s);
+    }
+    return IsPureDouble() ? double_ : int_;
+}
+
+std::string_view Node::AsString() const {
+    if (!IsString()) {
+        throw std::logic_error("Not a string"s);
+    }
+    return {chars_, size_};
+}
+
+ArrayView Node::AsArray() const {
+    if (!IsArray()) {
+        throw std::logic_error("Not an array"s);
+    }
+    return {items_, size_};
+}
+
+DictView Node::AsDict() const {
+    if (!IsDict()) {
+        throw std::logic_error("Not a dict"s);
+    }
+    return {members_, size_};
+}
+
+ArrayView::ArrayView(const Node* items, size_t size)
+    : items_(items)
+    , size_(size) {
+}
+
+const Node* ArrayView::begin() const {
+    return items_;
+}
+
+const Node* ArrayView::end() const {
+    return items_ + size_;
+}
+
+size_t ArrayView::size() const {
+    return size_;
+}
+
+bool ArrayView::empty() const {
+    return size_ == 0;
+}
+
+const Node& ArrayView::operator[](size_t index) const {
+    return items_[index];
+}
+
+DictView::DictView(const Member* members, size_t size)
+    : members_(members)
+    , size_(size) {
+}
+
+const Member* DictView::begin() const {
+    return members_;
+}
+
+const Member* DictView::end() const {
+    return members_ + size_;
+}
+
+size_t DictView::size() const {
+    return size_;
+}
+
+bool DictView::empty() const {
+    return size_ == 0;
+}
+
+const Node* DictView::Find(std::string_view key) const {
+    const Member* it = std::lower_bound(begin(), end(), key, [](const Member& member, std::string_view key) {
+        return member.key < key;
+    });
+    return it != end() && it->key == key ? &it->value : nullptr;
+}
+
+size_t DictView::count(std::string_view key) const {
+    return Find(key) != nullptr;
+}
+
+const Node& DictView::at(std::string_view key) const {
+    const Node* value = Find(key);
+    if (value == nullptr) {
+        throw std::out_of_range("No key '"s + std::string(key) + "' in a dict"s);
+    }
+    return *value;
+}
+
+Builder::Builder(std::pmr::memory_resource& arena, std::string_view input)
+    : arena_(arena)
+    , input_(input) {
+}
+
+bool Builder::IsComplete() const {
+    return is_complete_;
+}
+
+const Node& Builder::GetRoot() const {
+    return root_;
+}
+
+void Builder::Reset() {
+    values_.clear();
+    keys_.clear();
+    containers_.clear();
+    root_ = Node();
+    is_complete_ = false;
+}
+
+void Builder::StartDict() {
+    StartContainer();
+}
+
+void Builder::Key(std::string_view key) {
+    keys_.push_back(Store(key));
+}
+
+void Builder::EndDict() {
+    const Container container = containers_.back();
+    containers_.pop_back();
+    const size_t size = values_.size() - container.first_value;
+
+    auto* members = static_cast<Member*>(arena_.allocate(size * sizeof(Member), alignof(Member)));
+    for (size_t i = 0; i < size; ++i) {
+        new (members + i) Member{keys_[container.first_key + i], values_[container.first_value + i]};
+    }
+    // the parser has already rejected duplicate keys
+    std::sort(members, members + size, [](const Member& lhs, const Member& rhs) {
+        return lhs.key < rhs.key;
+    });
+    values_.resize(container.first_value);
+    keys_.resize(container.first_key);
+
+    Node node;
+    node.type_ = Node::Type::DICT;
+    node.size_ = static_cast<uint32_t>(size);
+    node.members_ = members;
+    AddValue(node);
+}
+
+void Builder::StartArray() {
+    StartContainer();
+}
+
+void Builder::EndArray() {
+    const Container container = containers_.back();
+    containers_.pop_back();
+    const size_t size = values_.size() - container.first_value;
+
+    auto* items = static_cast<Node*>(arena_.allocate(size * sizeof(Node), alignof(Node)));
+    std::uninitialized_copy(values_.begin() + container.first_value, values_.end(), items);
+    values_.resize(container.first_value);
+
+    Node node;
+    node.type_ = Node::Type::ARRAY;
+    node.size_ = static_cast<uint32_t>(size);
+    node.items_ = items;
+    AddValue(node);
+}
+
+void Builder::String(std::string_view value) {
+    const std::string_view stored = Store(value);
+    Node node;
+    node.type_ = Node::Type::STRING;
+    node.size_ = static_cast<uint32_t>(stored.size());
+    node.chars_ = stored.data();
+    AddValue(node);
+}
+
+void Builder::Int(int value) {
+    Node node;
+    node.type_ = Node::Type::INT;
+    node.int_ = value;
+    AddValue(node);
+}
+
+void Builder::Double(double value) {
+    Node node;
+    node.type_ = Node::Type::DOUBLE;
+    node.double_ = value;
+    AddValue(node);
+}
+
+void Builder::Bool(bool value) {
+    Node node;
+    node.type_ = Node::Type::BOOL;
+    node.bool_ = value;
+    AddValue(node);
+}
+
+void Builder::Null() {
+    AddValue(Node());
+}
+
+std::string_view Builder::Store(std::string_view text) {
+    if (text.data() >= input_.data() && text.data() + text.size() <= input_.data() + input_.size()) {
+        return text;
+    }
+    auto* chars = static_cast<char*>(arena_.allocate(text.size(), alignof(char)));
+    std::memcpy(chars, text.data(), text.size());
+    return {chars, text.size()};
+}
+
+void Builder::StartContainer() {
+    containers_.push_back({values_.size(), keys_.size()});
+}
+
+void Builder::AddValue(Node value) {
+    if (containers_.empty()) {
+        root_ = value;
+        is_complete_ = true;
+    } else {
+        values_.push_back(value);
+    }
+}
+
+}  // namespace json::arena
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "json.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+// Read-only JSON nodes that live in a monotonic arena and are freed all at once.
+// A dict is a sorted flat array of members, and keys and strings without escapes
+// point into the parsed text, so the text must outlive the nodes
+namespace json::arena {
+
+struct Member;
+class ArrayView;
+class DictView;
+
+class Node {
+public:
+    Node() = default;
+
+    bool IsNull() const;
+    bool IsBool() const;
+    bool IsInt() const;
+    bool IsPureDouble() const;
+    bool IsDouble() const;
+    bool IsString() const;
+    bool IsArray() const;
+    bool IsDict() const;
+
+    // Throw std::logic_error like the methods of json::Node
+    bool AsBool() const;
+    int AsInt() const;
+    double AsDouble() const;
+    std::string_view AsString() const;
+    ArrayView AsArray() const;
+    DictView AsDict() const;
+
+private:
+    friend class Builder;
+
+    enum class Type : uint8_t {
+        NULL_VALUE,
+        BOOL,
+        INT,
+        DOUBLE,
+        STRING,
+        ARRAY,
+        DICT,
+    };
+
+    Type type_ = Type::NULL_VALUE;
+    // Length of a string or number of items of an array or dict
+    uint32_t size_ = 0;
+    union {
+        bool bool_;
+        int int_;
+        double double_;
+        const char* chars_ = nullptr;
+        const Node* items_;
+        const Member* members_;
+    };
+};
+
+struct Member {
+    std::string_view key;
+    Node value;
+};
+
+class ArrayView {
+public:
+    ArrayView(const Node* items, size_t size);
+
+    const Node* begin() const;
+    const Node* end() const;
+    size_t size() const;
+    bool empty() const;
+    const Node& operator[](size_t index) const;
+
+private:
+    const Node* items_;
+    size_t size_;
+};
+
+// Members go in the order of keys, like in json::Dict
+class DictView {
+public:
+    DictView(const Member* members, size_t size);
+
+    const Member* begin() const;
+    const Member* end() const;
+    size_t size() const;
+    bool empty() const;
+    // Binary search over the keys, nullptr if there is no such key
+    const Node* Find(std::string_view key) const;
+    size_t count(std::string_view key) const;
+    // Throws std::out_of_range if there is no such key
+    const Node& at(std::string_view key) const;
+
+private:
+    const Member* members_;
+    size_t size_;
+};
+
+// Builds nodes in the arena from the events of json::Parse. Can be reused for
+// several values in a row, every value is available from GetRoot once its last event has come
+class Builder final : public Handler {
+public:
+    // Keys and strings inside input are referenced, the others are copied into the arena
+    Builder(std::pmr::memory_resource& arena, std::string_view input);
+
+    // Returns true once a whole value has been built
+    bool IsComplete() const;
+    const Node& GetRoot() const;
+    // Forgets the built value, the arena is left as it is
+    void Reset();
+
+    void StartDict() override;
+    void Key(std::string_view key) override;
+    void EndDict() override;
+    void StartArray() override;
+    void EndArray() override;
+    void String(std::string_view value) override;
+    void Int(int value) override;
+    void Double(double value) override;
+    void Bool(bool value) override;
+    void Null() override;
+
+private:
+    struct Container {
+        size_t first_value;
+        size_t first_key;
+    };
+
+    std::string_view Store(std::string_view text);
+    void StartContainer();
+    void AddValue(Node value);
+
+    std::pmr::memory_resource& arena_;
+    std::string_view input_;
+    // Values and keys of the open containers, moved into the arena when a container is closed
+    std::vector<Node> values_;
+    std::vector<std::string_view> keys_;
+    std::vector<Container> containers_;
+    Node root_;
+    bool is_complete_ = false;
+};
+
+}  // namespace json::arena
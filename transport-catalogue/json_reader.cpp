@@ -1,60 +1,487 @@
 #include "json_reader.h"
 
-void JSONReader::FillCatalogue(TransportCatalogue& catalogue) {
-    FillAllStops(catalogue);
-    FillAllRoutes(catalogue);
-    FillAllDistances(catalogue);
-}
-
-Document JSONReader::MakeJSON(const TransportCatalogue& catalogue, std::ostringstream& out) const {
-    Builder b;
-    auto info = b.StartArray();
-    for (auto req : stat_reqs_.AsArray()) {
-        Dict req_info;
-
-        if (req.AsDict().at("type"s).AsString() == "Stop"s) {                
-            std::optional<StopInfo> stop_info = catalogue.GetStopInfo(req.AsDict().at("name"s).AsString());            
-        // Fills the req_info map with information about the bus stop
-            FillStopReq(req_info, stop_info);
-        }       
-
-        if (req.AsDict().at("type"s).AsString() == "Bus"s) {             
-            std::optional<BusInfo> bus_info = catalogue.GetBusInfo(req.AsDict().at("name"s).AsString());
-            // Fills the req_info map with information about the bus
-            FillBusReq(req_info, bus_info);
-        }
-        
-        if (req.AsDict().at("type"s).AsString() == "Map"s) {             
-        // Adds a map to the req_info map
-            req_info["map"] = Node(out.str());
-        }
-        
-        if (req.AsDict().at("type"s).AsString() == "Route"s) {            
-            RouteReqInfo info =  tr_router_->GetRoutesInfo(req.AsDict().at("from"s).AsString(), req.AsDict().at("to"s).AsString());
-            FillRouteReq(req_info, info.route_info, info.total_time);            
-        }
-        
-        req_info["request_id"s] = Node(req.AsDict().at("id"s).AsInt());
-        info.Value(req_info);
-    }
-    
-    return Document(info.EndArray().Build());
-} 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory_resource>
+#include <stdexcept>
 
-std::vector<std::string> JSONReader::ProcessRoute(json::Node req) {
+template <typename NodeType>
+std::vector<std::string> JSONReader::ProcessRoute(const NodeType& req) {
     std::vector<std::string> stops;
-    for (auto stop : req.AsDict().at("stops"s).AsArray()) {               
-        stops.push_back(stop.AsString());
+    for (const auto& stop : req.AsDict().at("stops"s).AsArray()) {               
+        stops.push_back(std::string(stop.AsString()));
     }
 
     if (req.AsDict().at("is_roundtrip"s).AsBool() == false) {
         for (int i = req.AsDict().at("stops"s).AsArray().size() - 2; i >= 0; --i) {
-            stops.push_back(req.AsDict().at("stops"s).AsArray()[i].AsString());
+            stops.push_back(std::string(req.AsDict().at("stops"s).AsArray()[i].AsString()));
         }         
     }              
     return stops;
 }
 
+namespace {
+
+// Answers are found batch by batch, so the memory they take does not grow with the number of requests
+constexpr size_t ANSWER_BATCH_SIZE = 1 << 14;
+// Requests a thread takes at a time, a route takes much longer to find than the other answers
+constexpr size_t ANSWER_GRAIN = 64;
+
+// Builds a json::Node from the events of json::Parse
+class NodeHandler final : public json::Handler {
+public:
+    Node Build() {
+        return builder_.Build();
+    }
+
+    void StartDict() override {
+        builder_.StartDict();
+    }
+
+    void Key(std::string_view key) override {
+        builder_.Key(std::string(key));
+    }
+
+    void EndDict() override {
+        builder_.EndDict();
+    }
+
+    void StartArray() override {
+        builder_.StartArray();
+    }
+
+    void EndArray() override {
+        builder_.EndArray();
+    }
+
+    void String(std::string_view value) override {
+        builder_.Value(std::string(value));
+    }
+
+    void Int(int value) override {
+        builder_.Value(value);
+    }
+
+    void Double(double value) override {
+        builder_.Value(value);
+    }
+
+    void Bool(bool value) override {
+        builder_.Value(value);
+    }
+
+    void Null() override {
+        builder_.Value(nullptr);
+    }
+
+private:
+    Builder builder_;
+};
+
+Document ParseDocument(std::string_view input) {
+    NodeHandler handler;
+    json::Parse(input, handler);
+    return Document(handler.Build());
+}
+
+} // namespace
+
+// Adds base requests to the catalogue in one pass over them. Stops are added at once,
+// a bus or a distance naming a stop that comes later waits for Finish
+class JSONReader::BaseRequestsLoader {
+public:
+    explicit BaseRequestsLoader(TransportCatalogue& catalogue)
+        : catalogue_(catalogue) {
+    }
+
+    // NodeType is json::Node or json::arena::Node
+    template <typename NodeType>
+    void Add(const NodeType& req) {
+        const auto& request = req.AsDict();
+        const std::string_view type = request.at("type"s).AsString();
+        if (type == "Stop"sv) {
+            const std::string_view name = request.at("name"s).AsString();
+            catalogue_.AddStop(name, {request.at("latitude"s).AsDouble(), request.at("longitude"s).AsDouble()});
+            Stop* from = catalogue_.FindStop(name);
+            for (const auto& [stop_to, distance] : request.at("road_distances"s).AsDict()) {
+                if (Stop* to = catalogue_.FindStop(stop_to)) {
+                    catalogue_.SetDistance(from, to, distance.AsInt());
+                } else {
+                    pending_distances_.push_back({from, std::string(stop_to), distance.AsInt()});
+                }
+            }
+        } else if (type == "Bus"sv) {
+            const std::string_view name = request.at("name"s).AsString();
+            const bool is_round = request.at("is_roundtrip"s).AsBool();
+            // buses keep the order of the input, so none can be added while an earlier one waits
+            if (pending_buses_.empty() && FindRouteStops(request.at("stops"s).AsArray(), is_round)) {
+                catalogue_.AddBus(name, route_stops_, is_round);
+            } else {
+                pending_buses_.push_back({std::string(name), ProcessRoute(req), is_round});
+            }
+        }
+    }
+
+    // Adds the buses and distances that refer to stops given later in the input
+    void Finish() {
+        for (const PendingBus& bus : pending_buses_) {
+            AddBus(bus);
+        }
+        for (const PendingDistance& distance : pending_distances_) {
+            // a stop that is never given in base_requests has no distances
+            if (Stop* to = catalogue_.FindStop(distance.to)) {
+                catalogue_.SetDistance(distance.from, to, distance.distance);
+            }
+        }
+        pending_buses_.clear();
+        pending_distances_.clear();
+    }
+
+private:
+    struct PendingBus {
+        std::string name;
+        std::vector<std::string> stops;
+        bool is_round;
+    };
+
+    struct PendingDistance {
+        Stop* from;
+        std::string to;
+        int distance;
+    };
+
+    // Fills route_stops_ like ProcessRoute does, false if some stop is not added yet
+    template <typename ArrayType>
+    bool FindRouteStops(const ArrayType& stops, bool is_round) {
+        route_stops_.clear();
+        for (const auto& stop : stops) {
+            Stop* found = catalogue_.FindStop(stop.AsString());
+            if (!found) {
+                return false;
+            }
+            route_stops_.push_back(found);
+        }
+        if (!is_round) {
+            for (int i = static_cast<int>(stops.size()) - 2; i >= 0; --i) {
+                route_stops_.push_back(route_stops_[i]);
+            }
+        }
+        return true;
+    }
+
+    void AddBus(const PendingBus& bus) {
+        route_stops_.clear();
+        for (const std::string& stop : bus.stops) {
+            route_stops_.push_back(catalogue_.FindStop(stop));
+        }
+        catalogue_.AddBus(bus.name, route_stops_, bus.is_round);
+    }
+
+    TransportCatalogue& catalogue_;
+    // Reused for every bus
+    std::vector<Stop*> route_stops_;
+    std::vector<PendingBus> pending_buses_;
+    std::vector<PendingDistance> pending_distances_;
+};
+
+// Feeds the events of the streaming mode: every base request is built in a small arena,
+// added to the catalogue and dropped, every other section is built as a whole
+class JSONReader::StreamHandler final : public json::Handler {
+public:
+    StreamHandler(JSONReader& reader, TransportCatalogue& catalogue, std::string_view input)
+        : reader_(reader)
+        , loader_(catalogue)
+        , request_buffer_(REQUEST_BUFFER_SIZE)
+        , request_arena_(request_buffer_.data(), request_buffer_.size())
+        , request_builder_(request_arena_, input) {
+    }
+
+    void StartDict() override {
+        if (json::Handler* target = BeginValue(ValueType::DICT)) {
+            target->StartDict();
+        }
+        ++depth_;
+    }
+
+    void Key(std::string_view key) override {
+        if (target_) {
+            target_->Key(key);
+        } else if (depth_ == 1) {
+            section_ = key;
+        }
+    }
+
+    void EndDict() override {
+        --depth_;
+        if (target_) {
+            target_->EndDict();
+            EndValue();
+        }
+    }
+
+    void StartArray() override {
+        if (json::Handler* target = BeginValue(ValueType::ARRAY)) {
+            target->StartArray();
+        }
+        ++depth_;
+    }
+
+    void EndArray() override {
+        --depth_;
+        if (target_) {
+            target_->EndArray();
+            EndValue();
+        } else if (depth_ == 1 && is_in_base_requests_) {
+            // all stops are known once base_requests are over
+            loader_.Finish();
+            is_in_base_requests_ = false;
+        }
+    }
+
+    void String(std::string_view value) override {
+        if (json::Handler* target = BeginValue(ValueType::SCALAR)) {
+            target->String(value);
+            EndValue();
+        }
+    }
+
+    void Int(int value) override {
+        if (json::Handler* target = BeginValue(ValueType::SCALAR)) {
+            target->Int(value);
+            EndValue();
+        }
+    }
+
+    void Double(double value) override {
+        if (json::Handler* target = BeginValue(ValueType::SCALAR)) {
+            target->Double(value);
+            EndValue();
+        }
+    }
+
+    void Bool(bool value) override {
+        if (json::Handler* target = BeginValue(ValueType::SCALAR)) {
+            target->Bool(value);
+            EndValue();
+        }
+    }
+
+    void Null() override {
+        if (json::Handler* target = BeginValue(ValueType::SCALAR)) {
+            target->Null();
+            EndValue();
+        }
+    }
+
+private:
+    // A request rarely needs more, larger ones take extra blocks until the next request
+    static constexpr size_t REQUEST_BUFFER_SIZE = 1 << 16;
+
+    enum class ValueType {
+        DICT,
+        ARRAY,
+        SCALAR,
+    };
+
+    // Returns the builder taking the value, starts one if the value has to be kept
+    json::Handler* BeginValue(ValueType type) {
+        if (target_) {
+            return target_;
+        }
+        if (depth_ == 0 && type != ValueType::DICT) {
+            throw std::logic_error("Not a dict"s);
+        }
+        if (depth_ == 1 && section_ == "base_requests"sv) {
+            if (type != ValueType::ARRAY) {
+                throw std::logic_error("Not an array"s);
+            }
+            is_in_base_requests_ = true;
+        } else if (depth_ == 1) {
+            section_builder_.emplace();
+            target_ = &*section_builder_;
+            build_depth_ = depth_;
+        } else if (depth_ == 2 && is_in_base_requests_) {
+            // the previous request is no longer needed
+            request_builder_.Reset();
+            request_arena_.release();
+            target_ = &request_builder_;
+            build_depth_ = depth_;
+        }
+        return target_;
+    }
+
+    // Takes the built value once its last event has come
+    void EndValue() {
+        if (depth_ != build_depth_) {
+            return;
+        }
+        target_ = nullptr;
+        if (build_depth_ == 2) {
+            loader_.Add(request_builder_.GetRoot());
+        } else if (Node* section = reader_.FindSection(section_)) {
+            *section = section_builder_->Build();
+        }
+    }
+
+    JSONReader& reader_;
+    BaseRequestsLoader loader_;
+    // Number of dicts and arrays around the current event
+    size_t depth_ = 0;
+    std::string section_;
+    bool is_in_base_requests_ = false;
+    // The builder taking the current value, nullptr when the value is not kept
+    json::Handler* target_ = nullptr;
+    size_t build_depth_ = 0;
+    std::optional<NodeHandler> section_builder_;
+    std::vector<std::byte> request_buffer_;
+    std::pmr::monotonic_buffer_resource request_arena_;
+    json::arena::Builder request_builder_;
+};
+
+JSONReader::JSONReader(std::string_view input)
+    : JSONReader(ParseDocument(input)) {
+}
+
+JSONReader::JSONReader(std::string_view input, TransportCatalogue& catalogue) {
+    StreamHandler handler(*this, catalogue, input);
+    json::Parse(input, handler);
+}
+
+void JSONReader::FillCatalogue(TransportCatalogue& catalogue) {
+    if (!base_reqs_.IsNull()) {
+        BaseRequestsLoader loader(catalogue);
+        for (const Node& req : base_reqs_.AsArray()) {
+            loader.Add(req);
+        }
+        loader.Finish();
+    }
+    catalogue.Finalize();
+}
+
+void JSONReader::WriteAnswers(const TransportCatalogue& catalogue, const RequestHandler& handler, json::Writer& writer,
+                              parallel::ThreadPool& pool) const {
+    writer.StartArray();
+    if (stat_reqs_.IsNull()) {
+        writer.EndArray();
+        return;
+    }
+    const Array& requests = stat_reqs_.AsArray();
+    std::vector<Answer> answers;
+    for (size_t batch_begin = 0; batch_begin < requests.size(); batch_begin += ANSWER_BATCH_SIZE) {
+        const size_t batch_size = std::min(ANSWER_BATCH_SIZE, requests.size() - batch_begin);
+        answers.assign(batch_size, Answer{});
+        // the catalogue and the router are only read here, so the requests are independent
+        pool.ParallelFor(batch_size, ANSWER_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                // a request that fails gets an error answer and the others are still answered
+                try {
+                    answers[i] = FindAnswer(catalogue, handler, requests[batch_begin + i].AsDict());
+                } catch (const std::logic_error&) {
+                    answers[i] = NotFoundAnswer{};
+                }
+            }
+        });
+        for (size_t i = 0; i < batch_size; ++i) {
+            WriteAnswer(writer, answers[i], requests[batch_begin + i].AsDict().at("id"s).AsInt());
+        }
+    }
+    writer.EndArray();
+}
+
+JSONReader::Answer JSONReader::FindAnswer(const TransportCatalogue& catalogue, const RequestHandler& handler,
+                                          const Dict& request) const {
+    const std::string& type = request.at("type"s).AsString();
+    if (type == "Stop"s) {
+        return catalogue.GetStopInfo(request.at("name"s).AsString());
+    }
+    if (type == "Bus"s) {
+        return catalogue.GetBusInfo(request.at("name"s).AsString());
+    }
+    if (type == "Map"s) {
+        if (const auto it = request.find("viewport"s); it != request.end()) {
+            const std::optional<renderer::Viewport> viewport = ProcessViewportNode(it->second);
+            if (!viewport) {
+                return MapAnswer{nullptr};
+            }
+            return MapAnswer{handler.GetMapViewport(*viewport)};
+        }
+        // the map is rendered by the first Map request and shared by the others
+        return MapAnswer{handler.GetMap()};
+    }
+    if (type == "Route"s) {
+        return tr_router_->GetRoutesInfo(catalogue.FindStop(request.at("from"s).AsString()),
+                                         catalogue.FindStop(request.at("to"s).AsString()));
+    }
+    return std::monostate{};
+}
+
+void JSONReader::WriteAnswer(json::Writer& writer, const Answer& answer, int id) const {
+    // every answer writes its keys in alphabetical order, the order json::Print gives a Dict
+    writer.StartDict();
+    if (const auto* stop_info = std::get_if<std::optional<StopInfo>>(&answer)) {
+        WriteStopReq(writer, *stop_info, id);
+    } else if (const auto* bus_info = std::get_if<std::optional<BusInfo>>(&answer)) {
+        WriteBusReq(writer, *bus_info, id);
+    } else if (const auto* route_info = std::get_if<RouteReqInfo>(&answer)) {
+        WriteRouteReq(writer, route_info->route_info, route_info->total_time, id);
+    } else if (const auto* map_answer = std::get_if<MapAnswer>(&answer)) {
+        if (!map_answer->map) {
+            WriteError(writer, id, "invalid viewport"sv);
+            writer.EndDict();
+            return;
+        }
+        writer.Key("map"sv);
+        writer.String(*map_answer->map);
+        WriteRequestId(writer, id);
+    } else if (std::holds_alternative<NotFoundAnswer>(answer)) {
+        WriteError(writer, id);
+    } else {
+        WriteRequestId(writer, id);
+    }
+    writer.EndDict();
+} 
+
+
+RoutingSettings JSONReader::GetRoutingSettings() const {
+    RoutingSettings settings;
+    settings.bus_wait_time = GetBusWaitTime();
+    settings.bus_velocity = GetBusVelocity();
+    // The engine is optional: all-pairs precomputation is kept as the default
+    if (routing_settings_.AsDict().count("router"s)) {
+        const std::string& router = routing_settings_.AsDict().at("router"s).AsString();
+        if (router == "all_pairs"s) {
+            settings.router_type = RouterType::ALL_PAIRS;
+        } else if (router == "all_pairs_flat"s) {
+            settings.router_type = RouterType::ALL_PAIRS_FLAT;
+        } else if (router == "dijkstra"s) {
+            settings.router_type = RouterType::DIJKSTRA;
+        } else if (router == "contraction_hierarchy"s) {
+            settings.router_type = RouterType::CONTRACTION_HIERARCHY;
+        } else {
+            throw std::invalid_argument("Unknown router type: "s + router);
+        }
+    }
+    if (routing_settings_.AsDict().count("graph_model"s)) {
+        const std::string& graph_model = routing_settings_.AsDict().at("graph_model"s).AsString();
+        if (graph_model == "spans"s) {
+            settings.graph_model = GraphModel::SPANS;
+        } else if (graph_model == "ride_chain"s) {
+            settings.graph_model = GraphModel::RIDE_CHAIN;
+        } else {
+            throw std::invalid_argument("Unknown graph model: "s + graph_model);
+        }
+    }
+    if (routing_settings_.AsDict().count("threads"s)) {
+        const int thread_count = routing_settings_.AsDict().at("threads"s).AsInt();
+        if (thread_count < 1) {
+            throw std::invalid_argument("Thread count should be positive"s);
+        }
+        settings.thread_count = thread_count;
+    }
+    return settings;
+}
+
 int  JSONReader::GetBusWaitTime() const {
     return routing_settings_.AsDict().at("bus_wait_time"s).AsInt();
 }
@@ -66,51 +493,79 @@ void JSONReader::SetTransportRouter(TransportRouter* tr_r) {
     tr_router_ = tr_r;
 }
 
-void JSONReader::FillStopReq(Dict& req_info, const std::optional<StopInfo>& stop_info) const {
+void JSONReader::WriteRequestId(json::Writer& writer, int id) {
+    writer.Key("request_id"sv);
+    writer.Int(id);
+}
+
+void JSONReader::WriteError(json::Writer& writer, int id, std::string_view message) {
+    writer.Key("error_message"sv);
+    writer.String(message);
+    WriteRequestId(writer, id);
+}
+
+void JSONReader::WriteStopReq(json::Writer& writer, const std::optional<StopInfo>& stop_info, int id) const {
     if (!stop_info) {
-        req_info["error_message"s] = Node("not found"s);
-        return void();
+        WriteError(writer, id);
+        return;
     }
-    Array buses;               
+    writer.Key("buses"sv);
+    writer.StartArray();
     for (const auto& bus : stop_info.value().buses) {
-        buses.push_back(Node(std::string(bus)));
-    }            
-    req_info["buses"s] = Node(buses);
+        writer.String(bus);
+    }
+    writer.EndArray();
+    WriteRequestId(writer, id);
 }
 
-void JSONReader::FillBusReq(Dict& req_info, const std::optional<BusInfo>& bus_info) const {
+void JSONReader::WriteBusReq(json::Writer& writer, const std::optional<BusInfo>& bus_info, int id) const {
     if (!bus_info) {
-        req_info["error_message"s] = Node("not found"s);
-        return void();
+        WriteError(writer, id);
+        return;
     }
-    req_info["curvature"] = Node(bus_info.value().curvature);
-    req_info["route_length"] = Node(bus_info.value().route_length);
-    req_info["stop_count"] = Node(bus_info.value().stops_on_route);
-    req_info["unique_stop_count"] = Node((int)bus_info.value().unique_stops_num);       
+    writer.Key("curvature"sv);
+    writer.Double(bus_info.value().curvature);
+    WriteRequestId(writer, id);
+    writer.Key("route_length"sv);
+    writer.Int(bus_info.value().route_length);
+    writer.Key("stop_count"sv);
+    writer.Int(bus_info.value().stops_on_route);
+    writer.Key("unique_stop_count"sv);
+    writer.Int((int)bus_info.value().unique_stops_num);
 }
 
-void JSONReader::FillRouteReq(Dict& req_info, const std::optional<std::vector<ActivityInfo>>& route_info, double total_time) const {            
+void JSONReader::WriteRouteReq(json::Writer& writer, const std::optional<std::vector<ActivityInfo>>& route_info, double total_time, int id) const {
     if (!route_info) {
-        req_info["error_message"s] = "not found"s;
-    } else {
-        Array activities;
-        for (const auto& activity : route_info.value()) {
-            Dict activity_to_fill;
-            if (activity.type == "Wait") {
-                activity_to_fill["type"] = Node("Wait"s);
-                activity_to_fill["stop_name"] = Node((std::string)activity.stop_name);
-                activity_to_fill["time"] = Node(activity.time);
-            } else {
-                activity_to_fill["type"] = Node("Bus"s);
-                activity_to_fill["bus"] = Node((std::string)activity.bus_name);
-                activity_to_fill["span_count"] = Node(activity.span_count);
-                activity_to_fill["time"] = Node(activity.time);
-            }
-            activities.push_back(activity_to_fill);
+        WriteError(writer, id);
+        return;
+    }
+    writer.Key("items"sv);
+    writer.StartArray();
+    for (const auto& activity : route_info.value()) {
+        writer.StartDict();
+        if (activity.type == "Wait") {
+            writer.Key("stop_name"sv);
+            writer.String(activity.stop_name);
+            writer.Key("time"sv);
+            writer.Double(activity.time);
+            writer.Key("type"sv);
+            writer.String("Wait"sv);
+        } else {
+            writer.Key("bus"sv);
+            writer.String(activity.bus_name);
+            writer.Key("span_count"sv);
+            writer.Int(activity.span_count);
+            writer.Key("time"sv);
+            writer.Double(activity.time);
+            writer.Key("type"sv);
+            writer.String("Bus"sv);
         }
-        req_info["items"s] = activities;
-        req_info["total_time"s] = Node(total_time);
-    }  
+        writer.EndDict();
+    }
+    writer.EndArray();
+    WriteRequestId(writer, id);
+    writer.Key("total_time"sv);
+    writer.Double(total_time);
 }
 
 renderer::RenderSettings JSONReader::GetRenderSettings() {
@@ -133,48 +588,68 @@ renderer::RenderSettings JSONReader::GetRenderSettings() {
     return settings;
 }
 
-std::map<std::string, bool> JSONReader::GetBusNameToRoundTrip() {
-    std::map<std::string, bool> name_to_roundtrip;
-    for (auto req : base_reqs_.AsArray()) {
-        if (req.AsDict().at("type"s).AsString() == "Bus") {
-            name_to_roundtrip[req.AsDict().at("name"s).AsString()] = req.AsDict().at("is_roundtrip"s).AsBool();
+std::optional<renderer::Viewport> JSONReader::ProcessViewportNode(const Node& node) {
+    if (!node.IsDict()) {
+        return std::nullopt;
+    }
+    const Dict& viewport_dict = node.AsDict();
+    const auto read_point = [&viewport_dict](const std::string& key) -> std::optional<svg::Point> {
+        const auto it = viewport_dict.find(key);
+        if (it == viewport_dict.end() || !it->second.IsArray() || it->second.AsArray().size() != 2
+            || !it->second.AsArray()[0].IsDouble() || !it->second.AsArray()[1].IsDouble()) {
+            return std::nullopt;
         }
+        return svg::Point{it->second.AsArray()[0].AsDouble(), it->second.AsArray()[1].AsDouble()};
+    };
+    const std::optional<svg::Point> min = read_point("min"s);
+    const std::optional<svg::Point> max = read_point("max"s);
+    if (!min || !max) {
+        return std::nullopt;
     }
-    return name_to_roundtrip;
-}
-
-void JSONReader::FillAllStops(TransportCatalogue& catalogue) {
-    for (auto req : base_reqs_.AsArray()) {
-        if (req.AsDict().at("type"s) == "Stop"s) {
-            catalogue.AddStop(req.AsDict().at("name"s).AsString(), {req.AsDict().at("latitude"s).AsDouble(), req.AsDict().at("longitude"s).AsDouble()});
+    renderer::Viewport viewport;
+    viewport.box = {*min, *max};
+    // The zoom is optional
+    if (const auto it = viewport_dict.find("zoom"s); it != viewport_dict.end()) {
+        if (!it->second.IsDouble()) {
+            return std::nullopt;
         }
+        viewport.zoom = it->second.AsDouble();
+    }
+    const double values[] = {viewport.box.min.x, viewport.box.min.y, viewport.box.max.x, viewport.box.max.y, viewport.zoom};
+    if (!std::all_of(std::begin(values), std::end(values), [](double value) { return std::isfinite(value); })
+        || viewport.box.min.x > viewport.box.max.x || viewport.box.min.y > viewport.box.max.y || viewport.zoom <= 0) {
+        return std::nullopt;
     }
+    return viewport;
 }
 
-void JSONReader::FillAllRoutes(TransportCatalogue& catalogue) {
-    for (auto req : base_reqs_.AsArray()) {        
-        if (req.AsDict().at("type"s) == "Bus"s) {            
-            std::vector<Stop*> stops_to_add;
-            std::vector<std::string> stops = ProcessRoute(req);           
-            for (auto stop : stops) {
-                stops_to_add.push_back(catalogue.FindStop(stop));
-            }           
-            catalogue.AddBus(req.AsDict().at("name"s).AsString(), stops_to_add, req.AsDict().at("is_roundtrip"s).AsBool());            
-        }
+std::string JSONReader::GetSerializationFile() const {
+    return serialization_settings_.AsDict().at("file"s).AsString();
+}
+
+Node* JSONReader::FindSection(std::string_view name) {
+    if (name == "stat_requests"sv) {
+        return &stat_reqs_;
+    } else if (name == "render_settings"sv) {
+        return &render_settings_;
+    } else if (name == "routing_settings"sv) {
+        return &routing_settings_;
+    } else if (name == "serialization_settings"sv) {
+        return &serialization_settings_;
     }
+    return nullptr;
 }
 
-void JSONReader::FillAllDistances(TransportCatalogue& catalogue) {
-    for (auto req : base_reqs_.AsArray()) {
-        if (req.AsDict().at("type"s) == "Stop"s) {
-            for (auto [stop_to, distance] : req.AsDict().at("road_distances"s).AsDict()) {
-                catalogue.SetDistance(catalogue.FindStop(req.AsDict().at("name"s).AsString()), catalogue.FindStop(stop_to), distance.AsInt());
-            } 
-        }
+Node JSONReader::TakeSection(Document& doc, const std::string& name) {
+    Dict& root = doc.GetRoot().AsDict();
+    const auto it = root.find(name);
+    if (it == root.end()) {
+        return Node{};
     }
+    return std::move(it->second);
 }
 
-svg::Color JSONReader::ProcessColorNode(Node node) {        
+svg::Color JSONReader::ProcessColorNode(const Node& node) {        
     if (node.IsArray()) {
         if (node.AsArray().size() == 3) {
             return svg::Rgb({(uint8_t)node.AsArray()[0].AsInt(),
@@ -191,9 +666,9 @@ svg::Color JSONReader::ProcessColorNode(Node node) {
     }
 }
 
-std::vector<svg::Color> JSONReader::ProcessPaletteNode(Node node) {
+std::vector<svg::Color> JSONReader::ProcessPaletteNode(const Node& node) {
     std::vector<svg::Color> colors;
-    for (Node color : node.AsArray()) {
+    for (const Node& color : node.AsArray()) {
         colors.push_back(ProcessColorNode(color));
     }
     return colors;
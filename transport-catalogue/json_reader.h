@@ -2,13 +2,20 @@
 
 #include "json.h"
 #include "json_builder.h"
+#include "json_arena.h"
 #include "transport_catalogue.h"
 #include "geo.h"
 #include "map_renderer.h"
+#include "request_handler.h"
 #include "transport_router.h"
+#include "thread_pool.h"
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <sstream>
+#include <variant>
 
 using namespace json;
 using namespace transport_catalogue;
@@ -17,36 +24,77 @@ using namespace std::literals;
 
 class JSONReader {
 public:
+    // Every section is optional: make_base input has no stat_requests,
+    // process_requests input has only stat_requests and serialization_settings
+    // The sections are moved out of the document
     JSONReader(Document doc)
-        : base_reqs_(doc.GetRoot().AsDict().at("base_requests"s))
-        , stat_reqs_(doc.GetRoot().AsDict().at("stat_requests"s))
-        , render_settings_(doc.GetRoot().AsDict().at("render_settings"s))
-        , routing_settings_(doc.GetRoot().AsDict().at("routing_settings"s))
+        : base_reqs_(TakeSection(doc, "base_requests"s))
+        , stat_reqs_(TakeSection(doc, "stat_requests"s))
+        , render_settings_(TakeSection(doc, "render_settings"s))
+        , routing_settings_(TakeSection(doc, "routing_settings"s))
+        , serialization_settings_(TakeSection(doc, "serialization_settings"s))
     {        
     }
+    // Parses the input and keeps every section like the constructor above, for input
+    // whose base_requests are not needed
+    explicit JSONReader(std::string_view input);
+    // Streaming mode: base_requests are added to the catalogue while the input is parsed
+    // and are never kept as nodes, the other sections are kept like in the mode above
+    JSONReader(std::string_view input, TransportCatalogue& catalogue);
     
+    // Adds the base requests to the catalogue and finalizes it
     void FillCatalogue(TransportCatalogue& catalogue);     
-    Document MakeJSON(const TransportCatalogue& catalogue, std::ostringstream& out) const;    
+    // Finds the answers to stat_requests on the threads of the pool and writes them in the order
+    // of the requests, a batch at a time. The map is taken from the handler
+    void WriteAnswers(const TransportCatalogue& catalogue, const RequestHandler& handler, json::Writer& writer,
+                      parallel::ThreadPool& pool) const;
     renderer::RenderSettings GetRenderSettings();
-    std::map<std::string, bool> GetBusNameToRoundTrip();
+    // Path of the binary base used by make_base and process_requests
+    std::string GetSerializationFile() const;
+    RoutingSettings GetRoutingSettings() const;
     int GetBusWaitTime() const;
     double GetBusVelocity() const;    
     void SetTransportRouter(TransportRouter* tr_r);
     
 private:
-    void FillAllStops(TransportCatalogue& catalogue);
-    void FillAllRoutes(TransportCatalogue& catalogue);
-    void FillAllDistances(TransportCatalogue& catalogue);
-    std::vector<std::string> ProcessRoute(json::Node req);    
-    void FillStopReq(Dict& req_info, const std::optional<StopInfo>& stop_info) const;    
-    void FillBusReq(Dict& req_info, const std::optional<BusInfo>& bus_info) const; 
-    void FillRouteReq(Dict& req_info, const std::optional<std::vector<ActivityInfo>>& route_info, double total_time) const;
-    svg::Color ProcessColorNode(Node node);    
-    std::vector<svg::Color> ProcessPaletteNode(Node node);    
+    class BaseRequestsLoader;
+    class StreamHandler;
+
+    // The map is the same for all Map requests without a viewport, nullptr for an invalid viewport
+    struct MapAnswer {
+        std::shared_ptr<const std::string> map;
+    };
+    // A request that could not be answered, such as a route to an unknown stop
+    struct NotFoundAnswer {
+    };
+    // What a stat request asks for, nothing for an unknown type
+    using Answer = std::variant<std::monostate, std::optional<StopInfo>, std::optional<BusInfo>, RouteReqInfo, MapAnswer,
+                                NotFoundAnswer>;
+
+    static Node TakeSection(Document& doc, const std::string& name);
+    // The member keeping the section, nullptr for base_requests and unknown sections
+    Node* FindSection(std::string_view name);
+    // Stop names of the route with the way back of a non-round route, for json::Node and json::arena::Node
+    template <typename NodeType>
+    static std::vector<std::string> ProcessRoute(const NodeType& req);    
+    // Safe to call from several threads at once
+    Answer FindAnswer(const TransportCatalogue& catalogue, const RequestHandler& handler, const Dict& request) const;
+    void WriteAnswer(json::Writer& writer, const Answer& answer, int id) const;
+    // The keys of an answer go with request_id among them in alphabetical order
+    static void WriteRequestId(json::Writer& writer, int id);
+    static void WriteError(json::Writer& writer, int id, std::string_view message = "not found"sv);
+    void WriteStopReq(json::Writer& writer, const std::optional<StopInfo>& stop_info, int id) const;
+    void WriteBusReq(json::Writer& writer, const std::optional<BusInfo>& bus_info, int id) const;
+    void WriteRouteReq(json::Writer& writer, const std::optional<std::vector<ActivityInfo>>& route_info, double total_time, int id) const;
+    svg::Color ProcessColorNode(const Node& node);    
+    // nullopt if the viewport is malformed or its box is empty or its zoom is not positive
+    static std::optional<renderer::Viewport> ProcessViewportNode(const Node& node);
+    std::vector<svg::Color> ProcessPaletteNode(const Node& node);    
     
     Node base_reqs_;
     Node stat_reqs_;
     Node render_settings_;
     Node routing_settings_;    
+    Node serialization_settings_;
     TransportRouter* tr_router_;
 };
\ No newline at end of file
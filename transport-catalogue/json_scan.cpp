@@ -0,0 +1,167 @@
+#include "json_scan.h"
+#include "cpu_features.h"
+
+#ifdef CPU_FEATURES_X86
+#include <immintrin.h>
+#endif
+
+namespace json::scan {
+
+namespace {
+
+using ScanFunc = size_t (*)(const char*, size_t);
+
+inline bool IsStringSpecial(char c) {
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+inline bool IsWhitespace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Handles the positions [begin, size) one at a time, also used for the tails of the vector loops
+size_t FindStringSpecialScalar(const char* data, size_t begin, size_t size) {
+    for (size_t i = begin; i < size; ++i) {
+        if (IsStringSpecial(data[i])) {
+            return i;
+        }
+    }
+    return size;
+}
+
+size_t SkipWhitespaceScalar(const char* data, size_t begin, size_t size) {
+    for (size_t i = begin; i < size; ++i) {
+        if (!IsWhitespace(data[i])) {
+            return i;
+        }
+    }
+    return size;
+}
+
+size_t FindStringSpecialGeneric(const char* data, size_t size) {
+    return FindStringSpecialScalar(data, 0, size);
+}
+
+size_t SkipWhitespaceGeneric(const char* data, size_t size) {
+    return SkipWhitespaceScalar(data, 0, size);
+}
+
+#ifdef CPU_FEATURES_X86
+
+__attribute__((target("sse2")))
+size_t FindStringSpecialSse2(const char* data, size_t size) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i max_control = _mm_set1_epi8(0x1F);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // a byte is a control character when the unsigned minimum with 0x1F leaves it unchanged
+        const __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, max_control), chunk));
+        const int mask = _mm_movemask_epi8(special);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return FindStringSpecialScalar(data, i, size);
+}
+
+__attribute__((target("sse2")))
+size_t SkipWhitespaceSse2(const char* data, size_t size) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i below_tab = _mm_set1_epi8('\t' - 1);
+    const __m128i above_cr = _mm_set1_epi8('\r' + 1);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // signed comparisons are fine here: bytes from 0x80 are negative and never whitespace
+        const __m128i whitespace = _mm_or_si128(
+            _mm_cmpeq_epi8(chunk, space),
+            _mm_and_si128(_mm_cmpgt_epi8(chunk, below_tab), _mm_cmplt_epi8(chunk, above_cr)));
+        const int mask = ~_mm_movemask_epi8(whitespace) & 0xFFFF;
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return SkipWhitespaceScalar(data, i, size);
+}
+
+__attribute__((target("avx2")))
+size_t FindStringSpecialAvx2(const char* data, size_t size) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i max_control = _mm256_set1_epi8(0x1F);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, max_control), chunk));
+        const unsigned mask = _mm256_movemask_epi8(special);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return FindStringSpecialScalar(data, i, size);
+}
+
+__attribute__((target("avx2")))
+size_t SkipWhitespaceAvx2(const char* data, size_t size) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i below_tab = _mm256_set1_epi8('\t' - 1);
+    const __m256i above_cr = _mm256_set1_epi8('\r' + 1);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i whitespace = _mm256_or_si256(
+            _mm256_cmpeq_epi8(chunk, space),
+            _mm256_and_si256(_mm256_cmpgt_epi8(chunk, below_tab), _mm256_cmpgt_epi8(above_cr, chunk)));
+        const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(whitespace));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return SkipWhitespaceScalar(data, i, size);
+}
+
+#endif
+
+ScanFunc SelectFindStringSpecial() {
+#ifdef CPU_FEATURES_X86
+    if (cpu::HasAvx2()) {
+        return FindStringSpecialAvx2;
+    }
+    if (cpu::HasSse2()) {
+        return FindStringSpecialSse2;
+    }
+#endif
+    return FindStringSpecialGeneric;
+}
+
+ScanFunc SelectSkipWhitespace() {
+#ifdef CPU_FEATURES_X86
+    if (cpu::HasAvx2()) {
+        return SkipWhitespaceAvx2;
+    }
+    if (cpu::HasSse2()) {
+        return SkipWhitespaceSse2;
+    }
+#endif
+    return SkipWhitespaceGeneric;
+}
+
+}  // namespace
+
+size_t FindStringSpecial(const char* data, size_t size) {
+    static const ScanFunc find_string_special = SelectFindStringSpecial();
+    return find_string_special(data, size);
+}
+
+size_t SkipWhitespace(const char* data, size_t size) {
+    static const ScanFunc skip_whitespace = SelectSkipWhitespace();
+    return skip_whitespace(data, size);
+}
+
+}  // namespace json::scan
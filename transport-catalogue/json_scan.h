@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+namespace json::scan {
+
+// Returns the index of the first quote, backslash or control character (below 0x20)
+// in data[0, size), or size if there is none. Everything before it can be copied as is
+// both when a string is parsed and when it is printed.
+size_t FindStringSpecial(const char* data, size_t size);
+
+// Returns the index of the first character in data[0, size) that is not a space,
+// \t, \n, \v, \f or \r, or size if there is none.
+size_t SkipWhitespace(const char* data, size_t size);
+
+// Both use AVX2 or SSE2 when the CPU supports them and give the same results on every path.
+
+}  // namespace json::scan
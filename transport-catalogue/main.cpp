@@ -1,32 +1,155 @@
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 
 #include "request_handler.h"
 #include "json_reader.h"
+#include "serialization.h"
+#include "thread_pool.h"
 #include "transport_router.h"
 
 using namespace std;
 using namespace transport_catalogue;
 
-int main() {
-    TransportCatalogue catalogue;    
-    
-    json::Document doc = json::Load(cin);    
-    JSONReader reader(doc); 
-    
-    reader.FillCatalogue(catalogue);
+namespace {
+
+enum class Mode {
+    // Builds everything from base_requests and answers stat_requests in one run
+    ALL,
+    // Builds the catalogue and the router and saves them to the serialization file
+    MAKE_BASE,
+    // Answers stat_requests using the base saved by make_base
+    PROCESS_REQUESTS,
+};
+
+struct Options {
+    Mode mode = Mode::ALL;
+    // Overrides routing_settings.threads
+    std::optional<size_t> thread_count;
+    json::PrintMode print_mode = json::PrintMode::PRETTY;
+};
+
+std::optional<Options> ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--threads"sv && i + 1 < argc) {
+            const int thread_count = std::atoi(argv[++i]);
+            if (thread_count < 1) {
+                return std::nullopt;
+            }
+            options.thread_count = thread_count;
+        } else if (arg == "--compact"sv) {
+            options.print_mode = json::PrintMode::COMPACT;
+        } else if (arg == "make_base"sv && i == 1) {
+            options.mode = Mode::MAKE_BASE;
+        } else if (arg == "process_requests"sv && i == 1) {
+            options.mode = Mode::PROCESS_REQUESTS;
+        } else {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
 
-    TransportRouter transport_router(catalogue, reader.GetBusWaitTime(), reader.GetBusVelocity());    
-    
-    renderer::RenderSettings settings;   
-    renderer::MapRenderer renderer(reader.GetRenderSettings());
+// Reads the whole stream into memory so that the document can be parsed from a buffer
+std::string ReadAll(std::istream& input) {
+    std::string content;
+    std::streambuf* buffer = input.rdbuf();
+    constexpr size_t CHUNK_SIZE = 1 << 16;
+    while (true) {
+        const size_t size = content.size();
+        content.resize(size + CHUNK_SIZE);
+        const std::streamsize read_count = buffer->sgetn(content.data() + size, CHUNK_SIZE);
+        content.resize(size + read_count);
+        if (read_count < static_cast<std::streamsize>(CHUNK_SIZE)) {
+            return content;
+        }
+    }
+}
+
+RoutingSettings GetRoutingSettings(const JSONReader& reader, const Options& options) {
+    RoutingSettings routing_settings = reader.GetRoutingSettings();
+    if (options.thread_count) {
+        routing_settings.thread_count = *options.thread_count;
+    }
+    return routing_settings;
+}
+
+void AnswerRequests(JSONReader& reader, const TransportCatalogue& catalogue, const renderer::RenderSettings& render_settings,
+                    TransportRouter& transport_router, size_t thread_count, const Options& options) {
+    renderer::MapRenderer renderer(render_settings);
     RequestHandler handler(catalogue, renderer);
     renderer.SetBusesToRender(handler.GetAllRoutesWithInfo());
-    renderer.SetInfoBusesToRoundtrip(reader.GetBusNameToRoundTrip());    
-    std::ostringstream out;
-    handler.RenderMap(out);    
+    renderer.SetThreadCount(thread_count);
     reader.SetTransportRouter(&transport_router);
-    Document doc_to_optput = reader.MakeJSON(catalogue, out);
-    
-    json::Print(doc_to_optput, cout);    
-}
\ No newline at end of file
+    // the map is rendered only when a Map request comes, the answers go to the output
+    // batch by batch as soon as they are found
+    parallel::ThreadPool pool(thread_count);
+    json::Writer writer(cout, options.print_mode);
+    reader.WriteAnswers(catalogue, handler, writer, pool);
+}
+
+void MakeBase(JSONReader& reader, TransportCatalogue& catalogue, const Options& options) {
+    reader.FillCatalogue(catalogue);
+
+    RoutingSettings routing_settings = GetRoutingSettings(reader, options);
+    // Only the flat layout of the all-pairs tables can be used from the mapped file,
+    // and it gives exactly the same routes
+    if (routing_settings.router_type == RouterType::ALL_PAIRS) {
+        routing_settings.router_type = RouterType::ALL_PAIRS_FLAT;
+    }
+    TransportRouter transport_router(catalogue, routing_settings);
+
+    serialization::SaveBase(reader.GetSerializationFile(), catalogue, reader.GetRenderSettings(), transport_router);
+}
+
+void ProcessRequests(JSONReader& reader, const Options& options) {
+    const serialization::MappedBase base(reader.GetSerializationFile());
+    TransportCatalogue catalogue;
+    base.FillCatalogue(catalogue);
+    const std::unique_ptr<TransportRouter> transport_router = base.MakeTransportRouter(catalogue);
+
+    // process_requests input has no routing_settings
+    AnswerRequests(reader, catalogue, base.GetRenderSettings(), *transport_router, options.thread_count.value_or(1), options);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::optional<Options> options = ParseOptions(argc, argv);
+    if (!options) {
+        cerr << "Usage: "sv << argv[0] << " [make_base | process_requests] [--threads N] [--compact]"sv << endl;
+        return 1;
+    }
+
+    const std::string input = ReadAll(cin);
+
+    switch (options->mode) {
+        case Mode::MAKE_BASE: {
+            // base_requests go straight into the catalogue while the input is parsed
+            TransportCatalogue catalogue;
+            JSONReader reader(input, catalogue);
+            MakeBase(reader, catalogue, *options);
+            break;
+        }
+        case Mode::PROCESS_REQUESTS: {
+            // the catalogue comes from the base
+            JSONReader reader(input);
+            ProcessRequests(reader, *options);
+            break;
+        }
+        case Mode::ALL: {
+            TransportCatalogue catalogue;
+            JSONReader reader(input, catalogue);
+            reader.FillCatalogue(catalogue);
+            const RoutingSettings routing_settings = GetRoutingSettings(reader, *options);
+            TransportRouter transport_router(catalogue, routing_settings);
+            AnswerRequests(reader, catalogue, reader.GetRenderSettings(), transport_router, routing_settings.thread_count, *options);
+            break;
+        }
+    }
+}
@@ -1,6 +1,124 @@
 #include "map_renderer.h"
 
+#include <cmath>
+#include <numeric>
+
 namespace renderer {
+
+namespace {
+
+svg::Point ToViewport(svg::Point point, const Viewport& viewport) {
+    return {(point.x - viewport.box.min.x) * viewport.zoom, (point.y - viewport.box.min.y) * viewport.zoom};
+}
+
+// The positions at which something taking the screen box around its position is seen in the viewport
+Box GetVisiblePositions(const Viewport& viewport, Box screen_box) {
+    return {{viewport.box.min.x - screen_box.max.x / viewport.zoom, viewport.box.min.y - screen_box.max.y / viewport.zoom},
+            {viewport.box.max.x - screen_box.min.x / viewport.zoom, viewport.box.max.y - screen_box.min.y / viewport.zoom}};
+}
+
+// About two items per cell if they are spread evenly
+double GetCellSize(Box bounds, size_t item_count) {
+    const double side = std::max({bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y, EPSILON});
+    return side / std::max(1., std::ceil(std::sqrt(item_count / 2.)));
+}
+
+bool IsInside(svg::Point point, Box box) {
+    return point.x >= box.min.x && point.x <= box.max.x && point.y >= box.min.y && point.y <= box.max.y;
+}
+
+Box GetSegmentBox(svg::Point from, svg::Point to) {
+    return {{std::min(from.x, to.x), std::min(from.y, to.y)}, {std::max(from.x, to.x), std::max(from.y, to.y)}};
+}
+
+bool Intersects(svg::Point from, svg::Point to, Box box) {
+    const Box segment_box = GetSegmentBox(from, to);
+    if (segment_box.max.x < box.min.x || segment_box.min.x > box.max.x
+        || segment_box.max.y < box.min.y || segment_box.min.y > box.max.y) {
+        return false;
+    }
+    // the boxes overlap, so the segment misses the box only if all its corners are on one side of the line
+    const auto side = [from, to](double x, double y) {
+        return (to.x - from.x) * (y - from.y) - (to.y - from.y) * (x - from.x);
+    };
+    const double sides[] = {side(box.min.x, box.min.y), side(box.min.x, box.max.y),
+                            side(box.max.x, box.min.y), side(box.max.x, box.max.y)};
+    return !(std::all_of(std::begin(sides), std::end(sides), [](double value) { return value > 0; })
+             || std::all_of(std::begin(sides), std::end(sides), [](double value) { return value < 0; }));
+}
+
+} // namespace
+
+    GridIndex::GridIndex(const std::vector<Item>& items, Box bounds, double cell_size)
+        : origin_(bounds.min)
+        , cell_size_(cell_size)
+        , column_count_(static_cast<size_t>((bounds.max.x - bounds.min.x) / cell_size) + 1)
+        , row_count_(static_cast<size_t>((bounds.max.y - bounds.min.y) / cell_size) + 1) {
+        // counts the items of every cell, then puts them in place
+        cell_begins_.assign(column_count_ * row_count_ + 1, 0);
+        for (const Item& item : items) {
+            ForEachCell(item, [this](size_t cell) {
+                ++cell_begins_[cell + 1];
+            });
+        }
+        std::partial_sum(cell_begins_.begin(), cell_begins_.end(), cell_begins_.begin());
+        items_.resize(cell_begins_.back());
+        std::vector<uint32_t> cell_ends(cell_begins_.begin(), cell_begins_.end() - 1);
+        for (const Item& item : items) {
+            ForEachCell(item, [this, &cell_ends, &item](size_t cell) {
+                items_[cell_ends[cell]++] = item.id;
+            });
+        }
+    }
+
+    template <typename Func>
+    void GridIndex::ForEachCell(const Item& item, const Func& func) const {
+        const svg::Point from = item.from.x <= item.to.x ? item.from : item.to;
+        const svg::Point to = item.from.x <= item.to.x ? item.to : item.from;
+        const size_t first_column = GetColumn(from.x);
+        const size_t last_column = GetColumn(to.x);
+        // the cells of every column the segment crosses, widened a little so that
+        // a segment going through a corner gets all the cells around it
+        const double margin = cell_size_ * 1e-9;
+        for (size_t column = first_column; column <= last_column; ++column) {
+            double begin_y = from.y;
+            double end_y = to.y;
+            if (first_column != last_column) {
+                const double slope = (to.y - from.y) / (to.x - from.x);
+                const double begin_x = column == first_column ? from.x : origin_.x + column * cell_size_;
+                const double end_x = column == last_column ? to.x : origin_.x + (column + 1) * cell_size_;
+                begin_y = from.y + (begin_x - from.x) * slope;
+                end_y = from.y + (end_x - from.x) * slope;
+            }
+            const size_t last_row = GetRow(std::max(begin_y, end_y) + margin);
+            for (size_t row = GetRow(std::min(begin_y, end_y) - margin); row <= last_row; ++row) {
+                func(row * column_count_ + column);
+            }
+        }
+    }
+
+    void GridIndex::Find(Box box, std::vector<uint32_t>& found) const {
+        found.clear();
+        if (items_.empty()) {
+            return;
+        }
+        for (size_t row = GetRow(box.min.y); row <= GetRow(box.max.y); ++row) {
+            const size_t row_begin = row * column_count_;
+            found.insert(found.end(), items_.begin() + cell_begins_[row_begin + GetColumn(box.min.x)],
+                         items_.begin() + cell_begins_[row_begin + GetColumn(box.max.x) + 1]);
+        }
+        // an item crossing several cells is found in each of them
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+    }
+
+    size_t GridIndex::GetColumn(double x) const {
+        return static_cast<size_t>(std::clamp(std::floor((x - origin_.x) / cell_size_), 0., static_cast<double>(column_count_ - 1)));
+    }
+
+    size_t GridIndex::GetRow(double y) const {
+        return static_cast<size_t>(std::clamp(std::floor((y - origin_.y) / cell_size_), 0., static_cast<double>(row_count_ - 1)));
+    }
     
     svg::Point SphereProjector::operator()(geo::Coordinates coords) const {
         return {
@@ -11,25 +129,196 @@ namespace renderer {
     
     void RoutesRenderer::Draw(svg::ObjectContainer& document) const {    
         SphereProjector projector = CreateProjector();
-        AddRouteLines(document, projector);
-        AddRouteNames(document, projector);   
-        std::set<Stop*, cmp> stops_to_render = GetStopsToRender();        
-        AddStopCircles(stops_to_render, document, projector);
-        AddStopNames(stops_to_render, document, projector);        
+        std::vector<Stop*> stops_to_render = GetStopsToRender();        
+        const std::vector<Part> parts = SplitIntoParts(stops_to_render.size());
+        if (!pool_) {
+            for (const Part& part : parts) {
+                DrawPart(part, stops_to_render, document, projector);
+            }
+            return;
+        }
+        // every part is drawn into its own document, they are joined in the order of drawing
+        std::vector<svg::Document> part_documents(parts.size());
+        pool_->ParallelFor(parts.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                DrawPart(parts[i], stops_to_render, part_documents[i], projector);
+            }
+        });
+        document.AddAll(part_documents.begin(), part_documents.end());
+    }
+    
+    std::vector<RoutesRenderer::Part> RoutesRenderer::SplitIntoParts(size_t stop_count) const {
+        const size_t parts_per_layer = pool_ ? pool_->GetThreadCount() * PARTS_PER_THREAD : 1;
+        std::vector<Part> parts;
+        const auto split = [&parts, parts_per_layer](Layer layer, size_t count) {
+            const size_t part_size = std::max<size_t>((count + parts_per_layer - 1) / parts_per_layer, 1);
+            for (size_t begin = 0; begin < count; begin += part_size) {
+                parts.push_back({layer, begin, std::min(begin + part_size, count)});
+            }
+        };
+        split(Layer::ROUTE_LINES, buses_to_render_.size());
+        split(Layer::ROUTE_NAMES, buses_to_render_.size());
+        split(Layer::STOP_CIRCLES, stop_count);
+        split(Layer::STOP_NAMES, stop_count);
+        return parts;
+    }
+    
+    void RoutesRenderer::DrawPart(const Part& part, const std::vector<Stop*>& stops_to_render, svg::ObjectContainer& document,
+                                  const SphereProjector& projector) const {
+        switch (part.layer) {
+            case Layer::ROUTE_LINES:
+                AddRouteLines(part.begin, part.end, document, projector);
+                break;
+            case Layer::ROUTE_NAMES:
+                AddRouteNames(part.begin, part.end, document, projector);
+                break;
+            case Layer::STOP_CIRCLES:
+                AddStopCircles(stops_to_render, part.begin, part.end, document, projector);
+                break;
+            case Layer::STOP_NAMES:
+                AddStopNames(stops_to_render, part.begin, part.end, document, projector);
+                break;
+        }
+    }
+    
+    void RoutesRenderer::DrawViewport(const MapIndex& index, const Viewport& viewport, svg::ObjectContainer& document) const {
+        AddViewportLines(index, viewport, document);
+        AddViewportRouteNames(index, viewport, document);
+        AddViewportStops(index, viewport, document);
+    }
+    
+    MapIndex RoutesRenderer::BuildIndex() const {
+        const SphereProjector projector = CreateProjector();
+        MapIndex index;
+        index.buses = buses_to_render_;
+        for (uint32_t bus_id = 0; bus_id < buses_to_render_.size(); ++bus_id) {
+            const Bus* bus = buses_to_render_[bus_id];
+            const uint32_t route_begin = index.route_points.size();
+            index.route_begins.push_back(route_begin);
+            for (Stop* stop : bus->stops_on_route) {
+                index.route_points.push_back(projector(stop->coordinates));
+            }
+            // the labels go where AddRouteNames puts them
+            const size_t middle = bus->stops_on_route.size() / 2;
+            index.bus_labels.push_back({bus_id, index.route_points[route_begin]});
+            if ((!bus->is_round) && (bus->stops_on_route[0]->name_of_stop != bus->stops_on_route[middle]->name_of_stop)) {
+                index.bus_labels.push_back({bus_id, index.route_points[route_begin + middle]});
+            }
+            index.max_bus_name_length = std::max(index.max_bus_name_length, bus->route.size());
+        }
+        index.route_begins.push_back(index.route_points.size());
+        index.stops = GetStopsToRender();
+        for (const Stop* stop : index.stops) {
+            index.stop_positions.push_back(projector(stop->coordinates));
+            index.max_stop_name_length = std::max(index.max_stop_name_length, stop->name_of_stop.size());
+        }
+        if (index.route_points.empty()) {
+            return index;
+        }
+        
+        Box bounds{index.route_points[0], index.route_points[0]};
+        for (svg::Point point : index.route_points) {
+            bounds.min = {std::min(bounds.min.x, point.x), std::min(bounds.min.y, point.y)};
+            bounds.max = {std::max(bounds.max.x, point.x), std::max(bounds.max.y, point.y)};
+        }
+        std::vector<GridIndex::Item> segments;
+        double length_sum = 0;
+        for (size_t bus_id = 0; bus_id < buses_to_render_.size(); ++bus_id) {
+            const uint32_t route_begin = index.route_begins[bus_id];
+            const uint32_t route_end = index.route_begins[bus_id + 1];
+            // a line of one stop is still drawn, as a segment of no length
+            if (route_end - route_begin == 1) {
+                segments.push_back({route_begin, index.route_points[route_begin], index.route_points[route_begin]});
+            }
+            for (uint32_t point = route_begin; point + 1 < route_end; ++point) {
+                const svg::Point from = index.route_points[point];
+                const svg::Point to = index.route_points[point + 1];
+                segments.push_back({point, from, to});
+                length_sum += std::abs(to.x - from.x) + std::abs(to.y - from.y);
+            }
+        }
+        // a segment crosses a few cells on average, however long the segments are
+        index.segments_grid = GridIndex(segments, bounds,
+                                        std::max(GetCellSize(bounds, segments.size()), length_sum / segments.size() / 2));
+        
+        std::vector<GridIndex::Item> points;
+        for (uint32_t label_id = 0; label_id < index.bus_labels.size(); ++label_id) {
+            points.push_back({label_id, index.bus_labels[label_id].position, index.bus_labels[label_id].position});
+        }
+        index.bus_labels_grid = GridIndex(points, bounds, GetCellSize(bounds, points.size()));
+        points.clear();
+        for (uint32_t stop_id = 0; stop_id < index.stop_positions.size(); ++stop_id) {
+            points.push_back({stop_id, index.stop_positions[stop_id], index.stop_positions[stop_id]});
+        }
+        index.stops_grid = GridIndex(points, bounds, GetCellSize(bounds, points.size()));
+        return index;
     }
     
     void RoutesRenderer::SetBusesToRender(const std::vector<Bus*>& buses) {
         buses_to_render_ = buses;
     }
     
+    void RoutesRenderer::SetThreadPool(parallel::ThreadPool* pool) {
+        pool_ = pool;
+    }
+    
     void RoutesRenderer::SetSettings(const RenderSettings& settings) {
         settings_ = settings;
+        styles_ = CreateStyles();
     }
     
-    void RoutesRenderer::SetInfoBusesToRoundtrip(std::map<std::string, bool> buses_to_roundtrip) {
-        buses_to_roundtrip_ = buses_to_roundtrip;
+    RoutesRenderer::Styles RoutesRenderer::CreateStyles() const {
+        Styles styles;
+        for (const svg::Color& color : settings_.color_palette) {
+            styles.route_lines.push_back(svg::Polyline()
+                                         .SetStrokeColor(color)
+                                         .SetFillColor(svg::NoneColor)
+                                         .SetStrokeWidth(settings_.line_width)
+                                         .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
+                                         .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND)
+                                         .MakeStyle());
+            styles.bus_names.push_back(svg::Text()
+                                       .SetOffset(settings_.bus_label_offset)
+                                       .SetFontSize(settings_.bus_label_font_size)
+                                       .SetFontFamily("Verdana"s)
+                                       .SetFontWeight("bold"s)
+                                       .SetFillColor(color)
+                                       .MakeStyle());
+        }
+        styles.bus_name_underlayer = svg::Text()
+                                     .SetOffset(settings_.bus_label_offset)
+                                     .SetFontSize(settings_.bus_label_font_size)
+                                     .SetFontFamily("Verdana"s)
+                                     .SetFontWeight("bold"s)
+                                     .SetFillColor(settings_.underlayer_color)
+                                     .SetStrokeColor(settings_.underlayer_color)
+                                     .SetStrokeWidth(settings_.underlayer_width)
+                                     .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
+                                     .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND)
+                                     .MakeStyle();
+        styles.stop_circle = svg::Circle()
+                             .SetRadius(settings_.stop_radius)
+                             .SetFillColor("white"s)
+                             .MakeStyle();
+        styles.stop_name_underlayer = svg::Text()
+                                      .SetOffset(settings_.stop_label_offset)
+                                      .SetFontSize(settings_.stop_label_font_size)
+                                      .SetFontFamily("Verdana"s)
+                                      .SetFillColor(settings_.underlayer_color)
+                                      .SetStrokeColor(settings_.underlayer_color)
+                                      .SetStrokeWidth(settings_.underlayer_width)
+                                      .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
+                                      .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND)
+                                      .MakeStyle();
+        styles.stop_name = svg::Text()
+                           .SetOffset(settings_.stop_label_offset)
+                           .SetFontSize(settings_.stop_label_font_size)
+                           .SetFontFamily("Verdana"s)
+                           .SetFillColor("black"s)
+                           .MakeStyle();
+        return styles;
     }
-
+    
     void RoutesRenderer::FillWithCoordinates(std::vector<geo::Coordinates>& coordinates) const {
         for (Bus* bus : buses_to_render_) {
             for (Stop* stop : bus->stops_on_route) {
@@ -53,138 +342,231 @@ namespace renderer {
         return polyline;
     }
     
-    void RoutesRenderer::AddRouteLines(svg::ObjectContainer& document, const SphereProjector& projector) const {
-        size_t color_index = 0;
+    void RoutesRenderer::AddRouteLines(size_t first_bus, size_t last_bus, svg::ObjectContainer& document, const SphereProjector& projector) const {
         size_t palette_size = settings_.color_palette.size();
         
-        for (Bus* bus : buses_to_render_) {
-            svg::Polyline route = CreateRoute(bus, projector);
-            route 
-                 .SetStrokeColor(settings_.color_palette[color_index])
-                 .SetFillColor(svg::NoneColor)
-                 .SetStrokeWidth(settings_.line_width)
-                 .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-                 .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
-                
-            ++color_index;
-            color_index %=  palette_size;
+        for (size_t bus_id = first_bus; bus_id < last_bus; ++bus_id) {
+            svg::Polyline route = CreateRoute(buses_to_render_[bus_id], projector);
+            route.SetStyle(styles_.route_lines[bus_id % palette_size]);
             
             document.Add(route);
         }
-        color_index = 0;
     }
     
     void RoutesRenderer::AddBusNameUnderlayer(Bus* bus, svg::Point position, svg::ObjectContainer& document) const {
         document.Add(svg::Text()
                      .SetPosition(position)
-                     .SetOffset(settings_.bus_label_offset)
-                     .SetFontSize(settings_.bus_label_font_size)
-                     .SetFontFamily("Verdana"s)
-                     .SetFontWeight("bold"s)
                      .SetData(bus->route)
-                     .SetFillColor(settings_.underlayer_color)
-                     .SetStrokeColor(settings_.underlayer_color)
-                     .SetStrokeWidth(settings_.underlayer_width)
-                     .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-                     .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND));
+                     .SetStyle(styles_.bus_name_underlayer));
     }
     
-    void RoutesRenderer::AddBusNameLabel(Bus* bus, svg::Color color, svg::Point position, svg::ObjectContainer& document) const {
+    void RoutesRenderer::AddBusNameLabel(Bus* bus, const svg::Style& style, svg::Point position, svg::ObjectContainer& document) const {
         document.Add(svg::Text()
                      .SetPosition(position)
-                     .SetOffset(settings_.bus_label_offset)
-                     .SetFontSize(settings_.bus_label_font_size)
-                     .SetFontFamily("Verdana"s)
-                     .SetFontWeight("bold"s)
                      .SetData(bus->route)
-                     .SetFillColor(color)); 
+                     .SetStyle(style)); 
     }
     
-    void RoutesRenderer::AddRouteNames(svg::ObjectContainer& document, const SphereProjector& projector) const {        
-        size_t color_index = 0;
+    void RoutesRenderer::AddRouteNames(size_t first_bus, size_t last_bus, svg::ObjectContainer& document, const SphereProjector& projector) const {        
         size_t palette_size = settings_.color_palette.size();        
     
-        for (Bus* bus : buses_to_render_) {
+        for (size_t bus_id = first_bus; bus_id < last_bus; ++bus_id) {
+            Bus* bus = buses_to_render_[bus_id];
+            const size_t color_index = bus_id % palette_size;
             AddBusNameUnderlayer(bus, projector(bus->stops_on_route[0]->coordinates), document);
-            AddBusNameLabel(bus, settings_.color_palette[color_index], projector(bus->stops_on_route[0]->coordinates), document);                  
+            AddBusNameLabel(bus, styles_.bus_names[color_index], projector(bus->stops_on_route[0]->coordinates), document);                  
             
-            if ((!buses_to_roundtrip_.at(bus->route)) &&
+            if ((!bus->is_round) &&
                 (bus->stops_on_route[0]->name_of_stop != bus->stops_on_route[(bus->stops_on_route).size()/2]->name_of_stop)) {
                 AddBusNameUnderlayer(bus, projector(bus->stops_on_route[(bus->stops_on_route).size()/2]->coordinates), document);
-                AddBusNameLabel(bus, settings_.color_palette[color_index], projector(bus->stops_on_route[(bus->stops_on_route).size()/2]->coordinates), document);                       
+                AddBusNameLabel(bus, styles_.bus_names[color_index], projector(bus->stops_on_route[(bus->stops_on_route).size()/2]->coordinates), document);                       
             } 
-            ++color_index;
-            color_index %=  palette_size;
         }
     }
     
-    std::set<Stop*, RoutesRenderer::cmp> RoutesRenderer::GetStopsToRender() const {        
-        std::set<Stop*, cmp> stops_to_render;
+    std::vector<Stop*> RoutesRenderer::GetStopsToRender() const {        
+        std::vector<Stop*> stops_to_render;
+        std::vector<bool> is_added;
         
         for(Bus* bus : buses_to_render_) {
             for (Stop* stop : bus->stops_on_route) {
-                stops_to_render.insert(stop);
+                if (stop->id >= is_added.size()) {
+                    is_added.resize(stop->id + 1);
+                }
+                if (!is_added[stop->id]) {
+                    is_added[stop->id] = true;
+                    stops_to_render.push_back(stop);
+                }
             }
         }
+        std::sort(stops_to_render.begin(), stops_to_render.end(), [](const Stop* left, const Stop* right) {
+            return left->name_of_stop < right->name_of_stop;
+        });
         return stops_to_render;
     }
     
-    void RoutesRenderer::AddStopCircles(std::set<Stop*, cmp> stops_to_render, svg::ObjectContainer& document, const SphereProjector& projector) const {        
-        for (Stop* stop : stops_to_render) {
+    void RoutesRenderer::AddStopCircles(const std::vector<Stop*>& stops_to_render, size_t first_stop, size_t last_stop,
+                                        svg::ObjectContainer& document, const SphereProjector& projector) const {        
+        for (size_t stop_id = first_stop; stop_id < last_stop; ++stop_id) {
+            Stop* stop = stops_to_render[stop_id];
             document.Add(svg::Circle()
                                     .SetCenter(projector(stop->coordinates))
-                                    .SetRadius(settings_.stop_radius)
-                                    .SetFillColor("white"s));
+                                    .SetStyle(styles_.stop_circle));
         }
     }
     
     void RoutesRenderer::AddStopNameUnderlayer(Stop* stop, svg::Point position, svg::ObjectContainer& document) const {
         document.Add(svg::Text()
                              .SetPosition(position)
-                             .SetOffset(settings_.stop_label_offset)
-                             .SetFontSize(settings_.stop_label_font_size)
-                             .SetFontFamily("Verdana"s)                                  
                              .SetData(stop->name_of_stop)
-                             .SetFillColor(settings_.underlayer_color)
-                             .SetStrokeColor(settings_.underlayer_color)
-                             .SetStrokeWidth(settings_.underlayer_width)
-                             .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-                             .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND));
+                             .SetStyle(styles_.stop_name_underlayer));
     }
     
     void RoutesRenderer::AddStopNameLabel(Stop* stop, svg::Point position, svg::ObjectContainer& document) const {
         document.Add(svg::Text()
                              .SetPosition(position)
-                             .SetOffset(settings_.stop_label_offset)
-                             .SetFontSize(settings_.stop_label_font_size)
-                             .SetFontFamily("Verdana"s)                                  
                              .SetData(stop->name_of_stop)
-                             .SetFillColor("black"s));     
+                             .SetStyle(styles_.stop_name));     
     }
     
-    void RoutesRenderer::AddStopNames(std::set<Stop*, cmp> stops_to_render, svg::ObjectContainer& document, const SphereProjector& projector) const {
-         for (Stop* stop : stops_to_render) {
+    void RoutesRenderer::AddStopNames(const std::vector<Stop*>& stops_to_render, size_t first_stop, size_t last_stop,
+                                      svg::ObjectContainer& document, const SphereProjector& projector) const {
+         for (size_t stop_id = first_stop; stop_id < last_stop; ++stop_id) {
+            Stop* stop = stops_to_render[stop_id];
             AddStopNameUnderlayer(stop, projector(stop->coordinates), document);
             AddStopNameLabel(stop, projector(stop->coordinates), document);    
         }
     } 
     
+    Box RoutesRenderer::GetLabelBox(svg::Point offset, int font_size, size_t name_length) const {
+        // glyphs are not measured: no Verdana glyph is wider than the font size, and a name
+        // has no more letters than bytes
+        const double margin = settings_.underlayer_width / 2;
+        return {{offset.x - margin, offset.y - font_size - margin},
+                {offset.x + static_cast<double>(font_size) * name_length + margin, offset.y + font_size / 2. + margin}};
+    }
+    
+    void RoutesRenderer::AddViewportLines(const MapIndex& index, const Viewport& viewport, svg::ObjectContainer& document) const {
+        const double margin = settings_.line_width / 2;
+        const Box visible_box = GetVisiblePositions(viewport, {{-margin, -margin}, {margin, margin}});
+        std::vector<uint32_t> segments;
+        index.segments_grid.Find(visible_box, segments);
+        segments.erase(std::remove_if(segments.begin(), segments.end(), [&index, visible_box](uint32_t segment) {
+            // the segment of a line of one stop ends where it begins
+            const bool is_point = std::binary_search(index.route_begins.begin(), index.route_begins.end(), segment + 1);
+            const uint32_t to = is_point ? segment : segment + 1;
+            return !Intersects(index.route_points[segment], index.route_points[to], visible_box);
+        }), segments.end());
+        
+        // the segments are in the order of buses, consecutive ones of a bus make one line
+        for (size_t run_begin = 0; run_begin < segments.size();) {
+            const size_t bus_id = std::upper_bound(index.route_begins.begin(), index.route_begins.end(), segments[run_begin])
+                                  - index.route_begins.begin() - 1;
+            const uint32_t last_point = index.route_begins[bus_id + 1] - 1;
+            size_t run_end = run_begin + 1;
+            while (run_end < segments.size() && segments[run_end] == segments[run_end - 1] + 1 && segments[run_end] < last_point) {
+                ++run_end;
+            }
+            svg::Polyline line;
+            for (uint32_t point = segments[run_begin]; point <= std::min(segments[run_end - 1] + 1, last_point); ++point) {
+                line.AddPoint(ToViewport(index.route_points[point], viewport));
+            }
+            line.SetStyle(styles_.route_lines[bus_id % styles_.route_lines.size()]);
+            document.Add(line);
+            run_begin = run_end;
+        }
+    }
+    
+    void RoutesRenderer::AddViewportRouteNames(const MapIndex& index, const Viewport& viewport, svg::ObjectContainer& document) const {
+        std::vector<uint32_t> labels;
+        index.bus_labels_grid.Find(GetVisiblePositions(viewport, GetLabelBox(settings_.bus_label_offset, settings_.bus_label_font_size,
+                                                                             index.max_bus_name_length)), labels);
+        for (uint32_t label_id : labels) {
+            const MapIndex::BusLabel& label = index.bus_labels[label_id];
+            Bus* bus = index.buses[label.bus];
+            const Box label_box = GetLabelBox(settings_.bus_label_offset, settings_.bus_label_font_size, bus->route.size());
+            if (!IsInside(label.position, GetVisiblePositions(viewport, label_box))) {
+                continue;
+            }
+            const svg::Point position = ToViewport(label.position, viewport);
+            AddBusNameUnderlayer(bus, position, document);
+            AddBusNameLabel(bus, styles_.bus_names[label.bus % styles_.bus_names.size()], position, document);
+        }
+    }
+    
+    void RoutesRenderer::AddViewportStops(const MapIndex& index, const Viewport& viewport, svg::ObjectContainer& document) const {
+        std::vector<uint32_t> stops;
+        const double radius = settings_.stop_radius;
+        const Box visible_circles = GetVisiblePositions(viewport, {{-radius, -radius}, {radius, radius}});
+        index.stops_grid.Find(visible_circles, stops);
+        for (uint32_t stop_id : stops) {
+            if (IsInside(index.stop_positions[stop_id], visible_circles)) {
+                document.Add(svg::Circle()
+                             .SetCenter(ToViewport(index.stop_positions[stop_id], viewport))
+                             .SetStyle(styles_.stop_circle));
+            }
+        }
+        
+        index.stops_grid.Find(GetVisiblePositions(viewport, GetLabelBox(settings_.stop_label_offset, settings_.stop_label_font_size,
+                                                                        index.max_stop_name_length)), stops);
+        for (uint32_t stop_id : stops) {
+            Stop* stop = index.stops[stop_id];
+            const Box label_box = GetLabelBox(settings_.stop_label_offset, settings_.stop_label_font_size, stop->name_of_stop.size());
+            if (!IsInside(index.stop_positions[stop_id], GetVisiblePositions(viewport, label_box))) {
+                continue;
+            }
+            const svg::Point position = ToViewport(index.stop_positions[stop_id], viewport);
+            AddStopNameUnderlayer(stop, position, document);
+            AddStopNameLabel(stop, position, document);
+        }
+    }
+    
     void MapRenderer::SetBusesToRender(std::vector<Bus*> buses_to_render) {
         buses_to_render_ = buses_to_render;
     }
     
-    void MapRenderer::SetInfoBusesToRoundtrip(std::map<std::string, bool> buses_to_roundtrip) {
-        buses_to_roundtrip_ = buses_to_roundtrip;
+    void MapRenderer::SetThreadCount(size_t thread_count) {
+        thread_count_ = thread_count;
     }
     
-    void MapRenderer::RenderMap(std::ostream& out) const {
+    void MapRenderer::Draw(svg::Document& doc) const {
         RoutesRenderer routes_renderer;
         routes_renderer.SetSettings(settings_);
         routes_renderer.SetBusesToRender(buses_to_render_);
-        routes_renderer.SetInfoBusesToRoundtrip(buses_to_roundtrip_);
-        svg::Document doc;
+        // the map is drawn once, so the threads live only while it is drawn
+        std::optional<parallel::ThreadPool> pool;
+        if (thread_count_ > 1) {
+            pool.emplace(thread_count_);
+            routes_renderer.SetThreadPool(&*pool);
+        }
         routes_renderer.Draw(doc);
+    }
+    
+    void MapRenderer::RenderMap(std::ostream& out) const {
+        svg::Document doc;
+        Draw(doc);
         doc.Render(out);
     } 
     
+    void MapRenderer::RenderMap(std::string& out) const {
+        svg::Document doc;
+        Draw(doc);
+        doc.Render(out);
+    } 
+    
+    MapIndex MapRenderer::BuildIndex() const {
+        RoutesRenderer routes_renderer;
+        routes_renderer.SetSettings(settings_);
+        routes_renderer.SetBusesToRender(buses_to_render_);
+        return routes_renderer.BuildIndex();
+    }
+    
+    void MapRenderer::RenderViewport(const MapIndex& index, const Viewport& viewport, std::string& out) const {
+        RoutesRenderer routes_renderer;
+        routes_renderer.SetSettings(settings_);
+        svg::Document doc;
+        routes_renderer.DrawViewport(index, viewport, doc);
+        doc.Render(out);
+    }
+    
 } //namespace renderer
\ No newline at end of file
@@ -3,10 +3,13 @@
 #include "geo.h"
 #include "svg.h"
 #include "domain.h"
+#include "thread_pool.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <optional>
+#include <utility>
 #include <vector>
 #include <variant>
 #include <map>
@@ -54,41 +57,157 @@ struct RenderSettings {
     std::vector<svg::Color> color_palette;    
 };
 
+struct Box {
+    svg::Point min;
+    svg::Point max;
+};
+
+// A part of the map: the box in the coordinates of the whole map, drawn zoom times larger
+// with its min corner at the origin. Lines, circles and labels keep their size at any zoom
+struct Viewport {
+    Box box;
+    double zoom = 1.0;
+};
+
+// Uniform grid over segments, finds the segments that may intersect a box
+// by looking only at the cells it covers
+class GridIndex {
+public:
+    // A point is a segment from and to the same place
+    struct Item {
+        uint32_t id;
+        svg::Point from;
+        svg::Point to;
+    };
+
+    GridIndex() = default;
+    // Every item goes to the cells it crosses, the parts out of the bounds go to the border cells
+    GridIndex(const std::vector<Item>& items, Box bounds, double cell_size);
+
+    // Replaces the content of found with the ids of the items sharing a cell with the box,
+    // ascending and without repeats
+    void Find(Box box, std::vector<uint32_t>& found) const;
+
+private:
+    size_t GetColumn(double x) const;
+    size_t GetRow(double y) const;
+    template <typename Func>
+    void ForEachCell(const Item& item, const Func& func) const;
+
+    svg::Point origin_;
+    double cell_size_ = 1.0;
+    size_t column_count_ = 0;
+    size_t row_count_ = 0;
+    // The items of cell i are items_[cell_begins_[i]] up to items_[cell_begins_[i + 1]], row by row
+    std::vector<uint32_t> cell_begins_;
+    std::vector<uint32_t> items_;
+};
+
+// Everything RoutesRenderer draws, projected once and indexed to render viewports
+struct MapIndex {
+    struct BusLabel {
+        uint32_t bus;
+        svg::Point position;
+    };
+
+    std::vector<Bus*> buses;
+    // The line of bus i goes through route_points from route_begins[i] up to route_begins[i + 1]
+    std::vector<uint32_t> route_begins;
+    std::vector<svg::Point> route_points;
+    // In the order the labels are drawn
+    std::vector<BusLabel> bus_labels;
+    // In alphabetical order
+    std::vector<Stop*> stops;
+    std::vector<svg::Point> stop_positions;
+    // Segment k goes from route_points[k] to route_points[k + 1]
+    GridIndex segments_grid;
+    GridIndex bus_labels_grid;
+    GridIndex stops_grid;
+    // Label sizes depend on the zoom, so the grids keep the label positions
+    // and a query is widened by the longest name
+    size_t max_bus_name_length = 0;
+    size_t max_stop_name_length = 0;
+};
+
 class RoutesRenderer : public svg::Drawable {
 public:
     void Draw(svg::ObjectContainer& document) const override;
+    // Draws only the lines, circles and labels seen in the viewport, in the order Draw gives them.
+    // A line is cut to the runs of its segments crossing the viewport
+    void DrawViewport(const MapIndex& index, const Viewport& viewport, svg::ObjectContainer& document) const;
+    MapIndex BuildIndex() const;
 
     void SetBusesToRender(const std::vector<Bus*>& buses);    
     void SetSettings(const RenderSettings& settings);    
-    void SetInfoBusesToRoundtrip(std::map<std::string, bool> buses_to_roundtrip);  
+    // Draw splits every layer into parts drawn on the threads of the pool, nullptr draws on this thread
+    void SetThreadPool(parallel::ThreadPool* pool);
 
 private:
+    static constexpr size_t PARTS_PER_THREAD = 4;
+
+    enum class Layer {
+        ROUTE_LINES,
+        ROUTE_NAMES,
+        STOP_CIRCLES,
+        STOP_NAMES,
+    };
+
+    // The objects of a layer for the buses or the stops from begin up to end
+    struct Part {
+        Layer layer;
+        size_t begin;
+        size_t end;
+    };
+
+    // The attributes shared by the elements of each kind, rendered once for all of them
+    struct Styles {
+        // One per palette color
+        std::vector<svg::Style> route_lines;
+        std::vector<svg::Style> bus_names;
+        svg::Style bus_name_underlayer;
+        svg::Style stop_circle;
+        svg::Style stop_name_underlayer;
+        svg::Style stop_name;
+    };
+
     std::vector<Bus*> buses_to_render_;
     RenderSettings settings_;
-    std::map<std::string, bool> buses_to_roundtrip_;
+    Styles styles_;
+    parallel::ThreadPool* pool_ = nullptr;
     
-    struct cmp {
-        bool operator() (const Stop* left, const Stop* right) const {
-            return left->name_of_stop < right->name_of_stop;
-        }
-    };
+    Styles CreateStyles() const;
 
     void FillWithCoordinates(std::vector<geo::Coordinates>& coordinates) const;
 
     SphereProjector CreateProjector() const; 
 
+    // The parts of all layers in the order of drawing, each layer split into about
+    // PARTS_PER_THREAD parts for every thread of the pool
+    std::vector<Part> SplitIntoParts(size_t stop_count) const;
+    void DrawPart(const Part& part, const std::vector<Stop*>& stops_to_render, svg::ObjectContainer& document,
+                  const SphereProjector& projector) const;
+
     svg::Polyline CreateRoute(Bus* bus, const SphereProjector& projector) const;    
-    void AddRouteLines(svg::ObjectContainer& document, const SphereProjector& projector) const;
+    void AddRouteLines(size_t first_bus, size_t last_bus, svg::ObjectContainer& document, const SphereProjector& projector) const;
 
     void AddBusNameUnderlayer(Bus* bus, svg::Point position, svg::ObjectContainer& document) const;    
-    void AddBusNameLabel(Bus* bus, svg::Color color, svg::Point position, svg::ObjectContainer& document) const;    
-    void AddRouteNames(svg::ObjectContainer& document, const SphereProjector& projector) const; 
+    void AddBusNameLabel(Bus* bus, const svg::Style& style, svg::Point position, svg::ObjectContainer& document) const;    
+    void AddRouteNames(size_t first_bus, size_t last_bus, svg::ObjectContainer& document, const SphereProjector& projector) const; 
 
-    std::set<Stop*, cmp> GetStopsToRender() const;    
-    void AddStopCircles(std::set<Stop*, cmp> stops_to_render, svg::ObjectContainer& document, const SphereProjector& projector) const;    
+    // Stops of the rendered buses without repeats, in alphabetical order
+    std::vector<Stop*> GetStopsToRender() const;    
+    void AddStopCircles(const std::vector<Stop*>& stops_to_render, size_t first_stop, size_t last_stop,
+                        svg::ObjectContainer& document, const SphereProjector& projector) const;    
     void AddStopNameUnderlayer(Stop* stop, svg::Point position, svg::ObjectContainer& document) const;    
     void AddStopNameLabel(Stop* stop, svg::Point position, svg::ObjectContainer& document) const;    
-    void AddStopNames(std::set<Stop*, cmp> stops_to_render, svg::ObjectContainer& document, const SphereProjector& projector) const;
+    void AddStopNames(const std::vector<Stop*>& stops_to_render, size_t first_stop, size_t last_stop,
+                      svg::ObjectContainer& document, const SphereProjector& projector) const;
+
+    // The box a label takes around its position on the screen, for a name of name_length bytes
+    Box GetLabelBox(svg::Point offset, int font_size, size_t name_length) const;
+    void AddViewportLines(const MapIndex& index, const Viewport& viewport, svg::ObjectContainer& document) const;
+    void AddViewportRouteNames(const MapIndex& index, const Viewport& viewport, svg::ObjectContainer& document) const;
+    void AddViewportStops(const MapIndex& index, const Viewport& viewport, svg::ObjectContainer& document) const;
 };
 
 class MapRenderer {
@@ -99,14 +218,24 @@ public:
         }
     
     void SetBusesToRender(std::vector<Bus*> buses_to_render);
-    void SetInfoBusesToRoundtrip(std::map<std::string, bool> buses_to_roundtrip);
+    // The whole map is drawn on this many threads, 1 by default
+    void SetThreadCount(size_t thread_count);
     
     void RenderMap(std::ostream& out) const;
+    // Appends the map to the text
+    void RenderMap(std::string& out) const;
+    // Projects the map once for any number of RenderViewport calls
+    MapIndex BuildIndex() const;
+    // Appends the part of the map seen in the viewport to the text
+    void RenderViewport(const MapIndex& index, const Viewport& viewport, std::string& out) const;
     
 private:    
     RenderSettings settings_;
     std::vector<Bus*> buses_to_render_;
-    std::map<std::string, bool> buses_to_roundtrip_;    
+    size_t thread_count_ = 1;
+
+    // Draws the whole map into the document
+    void Draw(svg::Document& doc) const;
 };
 
 template <typename PointInputIt>
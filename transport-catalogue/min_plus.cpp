@@ -0,0 +1,115 @@
+#include "min_plus.h"
+#include "cpu_features.h"
+
+#ifdef CPU_FEATURES_X86
+#include <immintrin.h>
+#endif
+
+namespace graph::min_plus {
+
+namespace {
+
+using RelaxRowFunc = void (*)(double, uint32_t, const double*, const uint32_t*, double*, uint32_t*, size_t);
+
+inline void UpdatePrevEdge(uint32_t prev_edge_from, const uint32_t* prev_edges_through, uint32_t* prev_edges_row,
+                           size_t column) {
+    prev_edges_row[column] = prev_edges_through[column] != NO_EDGE ? prev_edges_through[column] : prev_edge_from;
+}
+
+// Handles the columns [begin, count) one at a time, also used for the tails of the vector loops
+void RelaxRowScalar(double weight_from, uint32_t prev_edge_from,
+                    const double* weights_through, const uint32_t* prev_edges_through,
+                    double* weights_row, uint32_t* prev_edges_row, size_t begin, size_t count) {
+    for (size_t column = begin; column < count; ++column) {
+        const double candidate_weight = weight_from + weights_through[column];
+        if (candidate_weight < weights_row[column]) {
+            weights_row[column] = candidate_weight;
+            UpdatePrevEdge(prev_edge_from, prev_edges_through, prev_edges_row, column);
+        }
+    }
+}
+
+void RelaxRowGeneric(double weight_from, uint32_t prev_edge_from,
+                     const double* weights_through, const uint32_t* prev_edges_through,
+                     double* weights_row, uint32_t* prev_edges_row, size_t count) {
+    RelaxRowScalar(weight_from, prev_edge_from, weights_through, prev_edges_through,
+                   weights_row, prev_edges_row, 0, count);
+}
+
+#ifdef CPU_FEATURES_X86
+
+__attribute__((target("sse2")))
+void RelaxRowSse2(double weight_from, uint32_t prev_edge_from,
+                  const double* weights_through, const uint32_t* prev_edges_through,
+                  double* weights_row, uint32_t* prev_edges_row, size_t count) {
+    const __m128d from = _mm_set1_pd(weight_from);
+    size_t column = 0;
+    for (; column + 2 <= count; column += 2) {
+        const __m128d candidate = _mm_add_pd(from, _mm_loadu_pd(weights_through + column));
+        const __m128d current = _mm_loadu_pd(weights_row + column);
+        const __m128d less = _mm_cmplt_pd(candidate, current);
+        const int mask = _mm_movemask_pd(less);
+        // Improvements are rare once the matrix settles, so the common case does no stores
+        if (mask == 0) {
+            continue;
+        }
+        _mm_storeu_pd(weights_row + column, _mm_or_pd(_mm_and_pd(less, candidate), _mm_andnot_pd(less, current)));
+        for (int lane = 0; lane < 2; ++lane) {
+            if (mask & (1 << lane)) {
+                UpdatePrevEdge(prev_edge_from, prev_edges_through, prev_edges_row, column + lane);
+            }
+        }
+    }
+    RelaxRowScalar(weight_from, prev_edge_from, weights_through, prev_edges_through,
+                   weights_row, prev_edges_row, column, count);
+}
+
+__attribute__((target("avx2")))
+void RelaxRowAvx2(double weight_from, uint32_t prev_edge_from,
+                  const double* weights_through, const uint32_t* prev_edges_through,
+                  double* weights_row, uint32_t* prev_edges_row, size_t count) {
+    const __m256d from = _mm256_set1_pd(weight_from);
+    size_t column = 0;
+    for (; column + 4 <= count; column += 4) {
+        const __m256d candidate = _mm256_add_pd(from, _mm256_loadu_pd(weights_through + column));
+        const __m256d current = _mm256_loadu_pd(weights_row + column);
+        const __m256d less = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+        const int mask = _mm256_movemask_pd(less);
+        if (mask == 0) {
+            continue;
+        }
+        _mm256_storeu_pd(weights_row + column, _mm256_blendv_pd(current, candidate, less));
+        for (int lane = 0; lane < 4; ++lane) {
+            if (mask & (1 << lane)) {
+                UpdatePrevEdge(prev_edge_from, prev_edges_through, prev_edges_row, column + lane);
+            }
+        }
+    }
+    RelaxRowScalar(weight_from, prev_edge_from, weights_through, prev_edges_through,
+                   weights_row, prev_edges_row, column, count);
+}
+
+#endif
+
+RelaxRowFunc SelectRelaxRow() {
+#ifdef CPU_FEATURES_X86
+    if (cpu::HasAvx2()) {
+        return RelaxRowAvx2;
+    }
+    if (cpu::HasSse2()) {
+        return RelaxRowSse2;
+    }
+#endif
+    return RelaxRowGeneric;
+}
+
+}  // namespace
+
+void RelaxRow(double weight_from, uint32_t prev_edge_from,
+              const double* weights_through, const uint32_t* prev_edges_through,
+              double* weights_row, uint32_t* prev_edges_row, size_t count) {
+    static const RelaxRowFunc relax_row = SelectRelaxRow();
+    relax_row(weight_from, prev_edge_from, weights_through, prev_edges_through, weights_row, prev_edges_row, count);
+}
+
+}  // namespace graph::min_plus
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace graph::min_plus {
+
+inline constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+// Relaxes one row of an all-pairs matrix through a pivot vertex, column by column:
+// if weight_from + weights_through[j] < weights_row[j], the sum is stored and the predecessor
+// is taken from prev_edges_through[j] (or prev_edge_from when it is NO_EDGE).
+// Unreachable cells must hold +infinity. Uses AVX2 or SSE2 when the CPU supports them;
+// every lane performs exactly the scalar operations, so the results do not depend on the path.
+void RelaxRow(double weight_from, uint32_t prev_edge_from,
+              const double* weights_through, const uint32_t* prev_edges_through,
+              double* weights_row, uint32_t* prev_edges_row, size_t count);
+
+}  // namespace graph::min_plus
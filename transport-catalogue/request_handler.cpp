@@ -1,11 +1,11 @@
 #include "request_handler.h"
 
 std::optional<BusInfo> RequestHandler::GetBusStat(const std::string_view& bus_name) const {
-    return db_.GetBusInfo(std::string(bus_name));
+    return db_.GetBusInfo(bus_name);
 }
 
 std::set<std::string_view> RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
-    return db_.GetStopInfo(std::string(stop_name)).value().buses;
+    return db_.GetStopInfo(stop_name).value().buses;
 }
 
 std::set<std::string_view> RequestHandler::GetAllRoutes() {
@@ -15,18 +15,28 @@ std::set<std::string_view> RequestHandler::GetAllRoutes() {
 std::vector<Bus*> RequestHandler::GetAllRoutesWithInfo() {
     std::vector<Bus*> buses;
     for (auto bus : GetAllRoutes()) {
-        std::optional<BusInfo> bus_info = GetBusStat(bus);
-        if (bus_info) {
-            if (bus_info.value().stops_on_route == 0) {
-                continue;
-            } else {
-                buses.push_back(db_.FindBus(bus));
-            }
-        } 
+        Bus* bus_ptr = db_.FindBus(bus);
+        if (!bus_ptr->stops_on_route.empty()) {
+            buses.push_back(bus_ptr);
+        }
     }
     return buses;
 }
 
-void RequestHandler::RenderMap(std::ostringstream& out) const {
-    renderer_.RenderMap(out);
-}
\ No newline at end of file
+std::shared_ptr<const std::string> RequestHandler::GetMap() const {
+    std::call_once(map_rendered_, [this] {
+        std::string map;
+        renderer_.RenderMap(map);
+        map_ = std::make_shared<const std::string>(std::move(map));
+    });
+    return map_;
+}
+
+std::shared_ptr<const std::string> RequestHandler::GetMapViewport(const renderer::Viewport& viewport) const {
+    std::call_once(map_indexed_, [this] {
+        map_index_ = std::make_unique<const renderer::MapIndex>(renderer_.BuildIndex());
+    });
+    std::string map;
+    renderer_.RenderViewport(*map_index_, viewport, map);
+    return std::make_shared<const std::string>(std::move(map));
+}
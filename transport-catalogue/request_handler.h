@@ -2,7 +2,10 @@
 
 #include "map_renderer.h"
 #include "transport_catalogue.h"
-#include "sstream"
+
+#include <memory>
+#include <mutex>
+#include <string>
 
 class RequestHandler {
 public:    
@@ -23,9 +26,18 @@ public:
     // Returns all routes with at least one stop in alphabetical order
     std::vector<Bus*> GetAllRoutesWithInfo();
     
-    void RenderMap(std::ostringstream& out) const;
+    // Renders the map on the first call only, every call shares the same text.
+    // Safe to call from several threads at once
+    std::shared_ptr<const std::string> GetMap() const;
+    // Renders the part of the map seen in the viewport, the map is projected and indexed
+    // on the first call only. Safe to call from several threads at once
+    std::shared_ptr<const std::string> GetMapViewport(const renderer::Viewport& viewport) const;
 
 private:    
     const transport_catalogue::TransportCatalogue& db_;
     const renderer::MapRenderer& renderer_;
+    mutable std::once_flag map_rendered_;
+    mutable std::shared_ptr<const std::string> map_;
+    mutable std::once_flag map_indexed_;
+    mutable std::unique_ptr<const renderer::MapIndex> map_index_;
 };
@@ -14,20 +14,31 @@
 
 namespace graph {
 
+// Common interface of the engines answering point-to-point route queries over a graph
 template <typename Weight>
-class Router {
-private:
-    using Graph = DirectedWeightedGraph<Weight>;
-
+class RoutingEngine {
 public:
-    explicit Router(const Graph& graph);
-
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
     };
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+    virtual ~RoutingEngine() = default;
+};
+
+// Precomputes routes between all pairs of vertices (Floyd–Warshall), O(V^2) memory
+template <typename Weight>
+class Router final : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RoutingEngine<Weight>::RouteInfo;
+
+    explicit Router(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
 
 private:
     struct RouteInternalData {
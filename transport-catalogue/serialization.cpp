@@ -0,0 +1,482 @@
+#include "serialization.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace serialization {
+
+using namespace std::literals;
+using transport_catalogue::TransportCatalogue;
+
+namespace {
+
+constexpr char MAGIC[8] = {'T', 'C', 'B', 'A', 'S', 'E', '\0', '\0'};
+constexpr uint32_t VERSION = 4;
+// Route tables start at a cache line boundary of the mapping
+constexpr size_t TABLES_ALIGNMENT = 64;
+constexpr int64_t NO_BUS = -1;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t catalogue_offset;
+    uint64_t render_settings_offset;
+    uint64_t router_offset;
+    // Zero when the base has no all-pairs tables
+    uint64_t tables_offset;
+    uint64_t file_size;
+};
+
+class Writer {
+public:
+    explicit Writer(std::ostream& out)
+        : out_(out) {
+    }
+
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteArray(&value, 1);
+    }
+
+    template <typename T>
+    void WriteArray(const T* values, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out_.write(reinterpret_cast<const char*>(values), sizeof(T) * count);
+        offset_ += sizeof(T) * count;
+    }
+
+    void WriteString(std::string_view value) {
+        Write<uint64_t>(value.size());
+        WriteArray(value.data(), value.size());
+    }
+
+    // Pads with zeros up to the next multiple of alignment
+    void Align(size_t alignment) {
+        while (offset_ % alignment != 0) {
+            Write<char>(0);
+        }
+    }
+
+    uint64_t GetOffset() const {
+        return offset_;
+    }
+
+private:
+    std::ostream& out_;
+    uint64_t offset_ = 0;
+};
+
+class Reader {
+public:
+    Reader(const char* data, size_t size, uint64_t offset)
+        : data_(data)
+        , size_(size)
+        , offset_(offset) {
+    }
+
+    template <typename T>
+    T Read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, Advance(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string_view ReadString() {
+        const auto size = Read<uint64_t>();
+        return {Advance(size), size};
+    }
+
+    // Returns a pointer into the mapping; the data is expected to be aligned by the writer
+    template <typename T>
+    const T* ReadArray(size_t count) {
+        if (offset_ % alignof(T) != 0) {
+            throw SerializationError("Misaligned array in the base"s);
+        }
+        if (count > (size_ - std::min<uint64_t>(offset_, size_)) / sizeof(T)) {
+            throw SerializationError("Unexpected end of the base"s);
+        }
+        return reinterpret_cast<const T*>(Advance(sizeof(T) * count));
+    }
+
+private:
+    const char* Advance(size_t size) {
+        if (offset_ > size_ || size > size_ - offset_) {
+            throw SerializationError("Unexpected end of the base"s);
+        }
+        const char* position = data_ + offset_;
+        offset_ += size;
+        return position;
+    }
+
+    const char* data_;
+    size_t size_;
+    uint64_t offset_;
+};
+
+// Stops and buses are saved in the order of their ids, so the ids survive loading
+void WriteCatalogue(Writer& writer, const TransportCatalogue& catalogue) {
+    writer.Write<uint64_t>(catalogue.GetStops().size());
+    for (const Stop& stop : catalogue.GetStops()) {
+        writer.WriteString(stop.name_of_stop);
+        writer.Write(stop.coordinates.lat);
+        writer.Write(stop.coordinates.lng);
+    }
+
+    writer.Write<uint64_t>(catalogue.GetBuses().size());
+    for (const Bus& bus : catalogue.GetBuses()) {
+        writer.WriteString(bus.route);
+        writer.Write<uint8_t>(bus.is_round);
+        writer.Write<uint64_t>(bus.stops_on_route.size());
+        for (const Stop* stop : bus.stops_on_route) {
+            writer.Write(stop->id);
+        }
+    }
+
+    std::vector<std::pair<std::pair<uint32_t, uint32_t>, int32_t>> distances;
+    catalogue.ForEachDistance([&distances](const Stop* from, const Stop* to, int distance) {
+        distances.push_back({{from->id, to->id}, distance});
+    });
+    writer.Write<uint64_t>(distances.size());
+    for (const auto& [stops, distance] : distances) {
+        writer.Write(stops.first);
+        writer.Write(stops.second);
+        writer.Write(distance);
+    }
+}
+
+void WriteColor(Writer& writer, const svg::Color& color) {
+    writer.Write<uint8_t>(color.index());
+    if (const auto* name = std::get_if<std::string>(&color)) {
+        writer.WriteString(*name);
+    } else if (const auto* rgb = std::get_if<svg::Rgb>(&color)) {
+        writer.Write(rgb->red);
+        writer.Write(rgb->green);
+        writer.Write(rgb->blue);
+    } else if (const auto* rgba = std::get_if<svg::Rgba>(&color)) {
+        writer.Write(rgba->red);
+        writer.Write(rgba->green);
+        writer.Write(rgba->blue);
+        writer.Write(rgba->opacity);
+    }
+}
+
+svg::Color ReadColor(Reader& reader) {
+    switch (reader.Read<uint8_t>()) {
+        case 0:
+            return std::monostate{};
+        case 1:
+            return std::string(reader.ReadString());
+        case 2: {
+            svg::Rgb rgb;
+            rgb.red = reader.Read<uint8_t>();
+            rgb.green = reader.Read<uint8_t>();
+            rgb.blue = reader.Read<uint8_t>();
+            return rgb;
+        }
+        case 3: {
+            svg::Rgba rgba;
+            rgba.red = reader.Read<uint8_t>();
+            rgba.green = reader.Read<uint8_t>();
+            rgba.blue = reader.Read<uint8_t>();
+            rgba.opacity = reader.Read<double>();
+            return rgba;
+        }
+        default:
+            throw SerializationError("Unknown color type in the base"s);
+    }
+}
+
+void WriteRenderSettings(Writer& writer, const renderer::RenderSettings& settings) {
+    writer.Write(settings.width);
+    writer.Write(settings.height);
+    writer.Write(settings.padding);
+    writer.Write(settings.line_width);
+    writer.Write(settings.stop_radius);
+    writer.Write<int32_t>(settings.bus_label_font_size);
+    writer.Write<int32_t>(settings.stop_label_font_size);
+    writer.Write(settings.bus_label_offset.x);
+    writer.Write(settings.bus_label_offset.y);
+    writer.Write(settings.stop_label_offset.x);
+    writer.Write(settings.stop_label_offset.y);
+    WriteColor(writer, settings.underlayer_color);
+    writer.Write(settings.underlayer_width);
+    writer.Write<uint64_t>(settings.color_palette.size());
+    for (const svg::Color& color : settings.color_palette) {
+        WriteColor(writer, color);
+    }
+}
+
+void WriteRouter(Writer& writer, const TransportRouter& router) {
+    const RoutingSettings settings = router.GetRoutingSettings();
+    writer.Write<int32_t>(settings.bus_wait_time);
+    writer.Write(settings.bus_velocity);
+    writer.Write<uint32_t>(static_cast<uint32_t>(settings.router_type));
+    writer.Write<uint32_t>(static_cast<uint32_t>(settings.graph_model));
+
+    const std::vector<uint32_t> place_stop_ids = router.GetPlaceStopIds();
+    writer.Write<uint64_t>(place_stop_ids.size());
+    writer.WriteArray(place_stop_ids.data(), place_stop_ids.size());
+
+    const auto& graph = router.GetGraph();
+    writer.Write<uint64_t>(graph.GetVertexCount());
+    writer.Write<uint64_t>(graph.GetEdgeCount());
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        writer.Write<uint64_t>(edge.from);
+        writer.Write<uint64_t>(edge.to);
+        writer.Write(edge.weight);
+    }
+
+    for (const auto& route : router.GetEdgeIdToRoute()) {
+        writer.Write(route ? static_cast<int64_t>(route->first) : NO_BUS);
+        writer.Write<int32_t>(route ? route->second : 0);
+    }
+}
+
+void WriteTables(Writer& writer, const graph::FlatRouter<double>::Tables& tables, size_t vertex_count) {
+    writer.WriteArray(tables.weights, vertex_count * vertex_count);
+    writer.WriteArray(tables.prev_edges, vertex_count * vertex_count);
+}
+
+void WriteBase(std::ofstream& out, const TransportCatalogue& catalogue,
+               const renderer::RenderSettings& render_settings, const TransportRouter& router) {
+    Writer writer(out);
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    // Placeholder, rewritten once the section offsets are known
+    writer.Write(header);
+
+    header.catalogue_offset = writer.GetOffset();
+    WriteCatalogue(writer, catalogue);
+    header.render_settings_offset = writer.GetOffset();
+    WriteRenderSettings(writer, render_settings);
+    header.router_offset = writer.GetOffset();
+    WriteRouter(writer, router);
+    if (const auto tables = router.GetFlatTables()) {
+        writer.Align(TABLES_ALIGNMENT);
+        header.tables_offset = writer.GetOffset();
+        WriteTables(writer, *tables, router.GetGraph().GetVertexCount());
+    }
+    header.file_size = writer.GetOffset();
+
+    out.seekp(0);
+    Writer(out).Write(header);
+}
+
+}  // namespace
+
+void SaveBase(const std::string& path, const TransportCatalogue& catalogue,
+              const renderer::RenderSettings& render_settings, const TransportRouter& router) {
+    // The old base may be mapped by running processes, so it is never rewritten in place:
+    // the new one is written next to it and renamed over it
+    const std::string temp_path = path + ".tmp."s + std::to_string(getpid());
+    try {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw SerializationError("Failed to open "s + temp_path + " for writing"s);
+        }
+        WriteBase(out, catalogue, render_settings, router);
+        out.close();
+        if (!out) {
+            throw SerializationError("Failed to write "s + temp_path);
+        }
+    } catch (...) {
+        std::remove(temp_path.c_str());
+        throw;
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        const std::string error = std::strerror(errno);
+        std::remove(temp_path.c_str());
+        throw SerializationError("Failed to replace "s + path + ": "s + error);
+    }
+}
+
+MappedBase::MappedBase(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw SerializationError("Failed to open "s + path + ": "s + std::strerror(errno));
+    }
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(Header)) {
+        close(fd);
+        throw SerializationError(path + " is not a transport catalogue base"s);
+    }
+    size_ = file_stat.st_size;
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw SerializationError("Failed to map "s + path + ": "s + std::strerror(errno));
+    }
+    data_ = static_cast<const char*>(data);
+
+    const auto header = Reader(data_, size_, 0).Read<Header>();
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+        || header.file_size != size_) {
+        munmap(const_cast<char*>(data_), size_);
+        throw SerializationError(path + " is not a transport catalogue base of version "s + std::to_string(VERSION));
+    }
+}
+
+MappedBase::~MappedBase() {
+    munmap(const_cast<char*>(data_), size_);
+}
+
+void MappedBase::FillCatalogue(TransportCatalogue& catalogue) const {
+    const auto header = Reader(data_, size_, 0).Read<Header>();
+    Reader reader(data_, size_, header.catalogue_offset);
+
+    const auto stop_count = reader.Read<uint64_t>();
+    std::vector<Stop*> stops;
+    stops.reserve(stop_count);
+    for (uint64_t i = 0; i < stop_count; ++i) {
+        const std::string name(reader.ReadString());
+        geo::Coordinates coordinates;
+        coordinates.lat = reader.Read<double>();
+        coordinates.lng = reader.Read<double>();
+        catalogue.AddStop(name, coordinates);
+        stops.push_back(catalogue.FindStop(name));
+    }
+
+    const auto bus_count = reader.Read<uint64_t>();
+    for (uint64_t i = 0; i < bus_count; ++i) {
+        const std::string name(reader.ReadString());
+        const bool is_round = reader.Read<uint8_t>() != 0;
+        std::vector<Stop*> stops_on_route(reader.Read<uint64_t>());
+        for (Stop*& stop : stops_on_route) {
+            stop = stops.at(reader.Read<uint32_t>());
+        }
+        catalogue.AddBus(name, stops_on_route, is_round);
+    }
+
+    const auto distance_count = reader.Read<uint64_t>();
+    for (uint64_t i = 0; i < distance_count; ++i) {
+        Stop* from = stops.at(reader.Read<uint32_t>());
+        Stop* to = stops.at(reader.Read<uint32_t>());
+        catalogue.SetDistance(from, to, reader.Read<int32_t>());
+    }
+    catalogue.Finalize();
+}
+
+renderer::RenderSettings MappedBase::GetRenderSettings() const {
+    const auto header = Reader(data_, size_, 0).Read<Header>();
+    Reader reader(data_, size_, header.render_settings_offset);
+
+    renderer::RenderSettings settings;
+    settings.width = reader.Read<double>();
+    settings.height = reader.Read<double>();
+    settings.padding = reader.Read<double>();
+    settings.line_width = reader.Read<double>();
+    settings.stop_radius = reader.Read<double>();
+    settings.bus_label_font_size = reader.Read<int32_t>();
+    settings.stop_label_font_size = reader.Read<int32_t>();
+    settings.bus_label_offset.x = reader.Read<double>();
+    settings.bus_label_offset.y = reader.Read<double>();
+    settings.stop_label_offset.x = reader.Read<double>();
+    settings.stop_label_offset.y = reader.Read<double>();
+    settings.underlayer_color = ReadColor(reader);
+    settings.underlayer_width = reader.Read<double>();
+    settings.color_palette.resize(reader.Read<uint64_t>());
+    for (svg::Color& color : settings.color_palette) {
+        color = ReadColor(reader);
+    }
+    return settings;
+}
+
+std::unique_ptr<TransportRouter> MappedBase::MakeTransportRouter(const TransportCatalogue& catalogue) const {
+    const auto header = Reader(data_, size_, 0).Read<Header>();
+    Reader reader(data_, size_, header.router_offset);
+
+    RoutingSettings settings;
+    settings.bus_wait_time = reader.Read<int32_t>();
+    settings.bus_velocity = reader.Read<double>();
+    const auto router_type = reader.Read<uint32_t>();
+    if (router_type > static_cast<uint32_t>(RouterType::CONTRACTION_HIERARCHY)) {
+        throw SerializationError("Unknown router type in the base"s);
+    }
+    settings.router_type = static_cast<RouterType>(router_type);
+    const auto graph_model = reader.Read<uint32_t>();
+    if (graph_model > static_cast<uint32_t>(GraphModel::RIDE_CHAIN)) {
+        throw SerializationError("Unknown graph model in the base"s);
+    }
+    settings.graph_model = static_cast<GraphModel>(graph_model);
+
+    RouterData data;
+    // the stop vertices must be numbered like when the base was made, and each stop must get one place
+    const auto stop_count = static_cast<uint64_t>(catalogue.GetStopsCount());
+    if (reader.Read<uint64_t>() != stop_count) {
+        throw SerializationError("Stop order does not match the catalogue in the base"s);
+    }
+    data.place_stop_ids.reserve(stop_count);
+    std::vector<bool> is_placed(stop_count);
+    for (uint64_t place = 0; place < stop_count; ++place) {
+        const auto stop_id = reader.Read<uint32_t>();
+        if (stop_id >= stop_count || is_placed[stop_id]) {
+            throw SerializationError("Stop order does not match the catalogue in the base"s);
+        }
+        is_placed[stop_id] = true;
+        data.place_stop_ids.push_back(stop_id);
+    }
+
+    const auto vertex_count = reader.Read<uint64_t>();
+    if (vertex_count != TransportRouter::CountVertices(catalogue, settings.graph_model)) {
+        throw SerializationError("Vertex count does not match the catalogue in the base"s);
+    }
+    data.graph = graph::DirectedWeightedGraph<double>(vertex_count);
+    const auto edge_count = reader.Read<uint64_t>();
+    for (uint64_t i = 0; i < edge_count; ++i) {
+        graph::Edge<double> edge;
+        edge.from = reader.Read<uint64_t>();
+        edge.to = reader.Read<uint64_t>();
+        edge.weight = reader.Read<double>();
+        if (edge.from >= vertex_count || edge.to >= vertex_count) {
+            throw SerializationError("Edge vertex out of range in the base"s);
+        }
+        data.graph.AddEdge(edge);
+    }
+
+    const auto bus_count = static_cast<int64_t>(catalogue.GetBusesCount());
+    data.edge_id_to_route.reserve(edge_count);
+    for (uint64_t i = 0; i < edge_count; ++i) {
+        const auto bus_index = reader.Read<int64_t>();
+        const auto span_count = reader.Read<int32_t>();
+        if (bus_index == NO_BUS) {
+            data.edge_id_to_route.push_back(std::nullopt);
+        } else {
+            if (bus_index < 0 || bus_index >= bus_count) {
+                throw SerializationError("Unknown bus in the base"s);
+            }
+            data.edge_id_to_route.push_back(std::pair<uint32_t, int>{static_cast<uint32_t>(bus_index), span_count});
+        }
+    }
+
+    std::optional<graph::FlatRouter<double>::Tables> tables;
+    if (header.tables_offset != 0) {
+        // vertex_count * vertex_count must not overflow before it is checked against the file size
+        if (vertex_count > size_ / (sizeof(double) + sizeof(uint32_t)) / std::max<uint64_t>(vertex_count, 1)) {
+            throw SerializationError("Route tables do not fit in the base"s);
+        }
+        Reader tables_reader(data_, size_, header.tables_offset);
+        tables.emplace();
+        tables->weights = tables_reader.ReadArray<double>(vertex_count * vertex_count);
+        tables->prev_edges = tables_reader.ReadArray<uint32_t>(vertex_count * vertex_count);
+    }
+    return std::make_unique<TransportRouter>(catalogue, settings, std::move(data), tables);
+}
+
+}  // namespace serialization
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "map_renderer.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace serialization {
+
+class SerializationError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+/*
+ * Binary base written by make_base and opened by process_requests.
+ * The file starts with a header holding the offsets of its sections: the catalogue, the render
+ * settings, the routing graph with its lookup tables and, for all-pairs routers, the V x V route
+ * tables. Values are stored in the native byte order of the host that made the base.
+ */
+void SaveBase(const std::string& path, const transport_catalogue::TransportCatalogue& catalogue,
+              const renderer::RenderSettings& render_settings, const TransportRouter& router);
+
+/*
+ * Maps a base written by SaveBase into memory. The catalogue and the graph are decoded from the
+ * mapping, while the route tables are used in place, so several processes share them through
+ * the page cache. Routers made by MakeTransportRouter must not outlive the MappedBase.
+ */
+class MappedBase {
+public:
+    explicit MappedBase(const std::string& path);
+    MappedBase(const MappedBase&) = delete;
+    MappedBase& operator=(const MappedBase&) = delete;
+    ~MappedBase();
+
+    // Fills an empty catalogue with the saved stops, buses and distances and finalizes it
+    void FillCatalogue(transport_catalogue::TransportCatalogue& catalogue) const;
+    renderer::RenderSettings GetRenderSettings() const;
+    // The catalogue must be the one filled by FillCatalogue
+    std::unique_ptr<TransportRouter> MakeTransportRouter(const transport_catalogue::TransportCatalogue& catalogue) const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace serialization
@@ -1,83 +1,129 @@
 #include "svg.h"
+#include <charconv>
 #include <utility>
 #include <string>
 
 namespace svg {
 
 using namespace std::literals;
-    
-std::ostream& operator<<(std::ostream& stream, const StrokeLineCap& stroke_line_cap) {
+
+namespace detail {
+
+void AppendValue(std::string& out, double value) {
+    char chars[32];
+    const auto result = std::to_chars(chars, chars + sizeof(chars), value, std::chars_format::general, 6);
+    out.append(chars, result.ptr);
+}
+
+void AppendValue(std::string& out, uint32_t value) {
+    char chars[16];
+    const auto result = std::to_chars(chars, chars + sizeof(chars), value);
+    out.append(chars, result.ptr);
+}
+
+void AppendValue(std::string& out, const Color& color) {
+    if (std::holds_alternative<std::monostate>(color)) {
+        out.append("none"sv);
+        return;
+    }
+    if (std::holds_alternative<std::string>(color)) {
+        if (std::get<std::string>(color) == ""s) {
+            out.append("none"sv);
+        } else {
+            out.append(std::get<std::string>(color));
+        }
+        return;
+    }
+
+    if (std::holds_alternative<Rgb>(color)) {
+        const Rgb& rgb = std::get<Rgb>(color);
+        out.append("rgb("sv);
+        AppendValue(out, uint32_t{rgb.red});
+        out.push_back(',');
+        AppendValue(out, uint32_t{rgb.green});
+        out.push_back(',');
+        AppendValue(out, uint32_t{rgb.blue});
+        out.push_back(')');
+        return;
+    }
+    if (std::holds_alternative<Rgba>(color)) {
+        const Rgba& rgba = std::get<Rgba>(color);
+        out.append("rgba("sv);
+        AppendValue(out, uint32_t{rgba.red});
+        out.push_back(',');
+        AppendValue(out, uint32_t{rgba.green});
+        out.push_back(',');
+        AppendValue(out, uint32_t{rgba.blue});
+        out.push_back(',');
+        AppendValue(out, rgba.opacity);
+        out.push_back(')');
+        return;
+    }
+}
+
+void AppendValue(std::string& out, StrokeLineCap stroke_line_cap) {
     switch (stroke_line_cap) {
         case StrokeLineCap::BUTT:
-            stream << "butt";
+            out.append("butt"sv);
             break;
         case StrokeLineCap::ROUND:
-            stream << "round";
+            out.append("round"sv);
             break;
         case StrokeLineCap::SQUARE:
-            stream << "square";
-            break;                 
-    }    
-    return stream;
+            out.append("square"sv);
+            break;
+    }
 }
-    
-std::ostream& operator<<(std::ostream& stream, const StrokeLineJoin& stroke_line_join) {
+
+void AppendValue(std::string& out, StrokeLineJoin stroke_line_join) {
     switch (stroke_line_join) {
         case StrokeLineJoin::ARCS:
-            stream << "arcs";
+            out.append("arcs"sv);
             break;
         case StrokeLineJoin::BEVEL:
-            stream << "bevel";
+            out.append("bevel"sv);
             break;
         case StrokeLineJoin::MITER:
-            stream << "miter";
+            out.append("miter"sv);
             break;
         case StrokeLineJoin::MITER_CLIP:
-            stream << "miter-clip";
+            out.append("miter-clip"sv);
             break;
         case StrokeLineJoin::ROUND:
-            stream << "round";
-            break; 
-    }    
-    return stream;
+            out.append("round"sv);
+            break;
+    }
+}
+
+} // namespace detail
+
+std::ostream& operator<<(std::ostream& stream, const StrokeLineCap& stroke_line_cap) {
+    std::string text;
+    detail::AppendValue(text, stroke_line_cap);
+    return stream << text;
 }
-    
+
+std::ostream& operator<<(std::ostream& stream, const StrokeLineJoin& stroke_line_join) {
+    std::string text;
+    detail::AppendValue(text, stroke_line_join);
+    return stream << text;
+}
+
 std::ostream& operator<<(std::ostream& out, const Color& color) {
-    if (std::holds_alternative<std::monostate>(color)) {
-        out << "none";
-        return out;
-    }
-    if (std::holds_alternative<std::string>(color)) {
-        if (std::get<std::string>(color) == ""s) {
-            out << "none";
-        } else {
-            out << std::get<std::string>(color);
-        }           
-        return out;
-    }
-    
-    if (std::holds_alternative<Rgb>(color)) {
-        out << "rgb(" << (int)std::get<Rgb>(color).red
-        << "," << (int)std::get<Rgb>(color).green
-        << "," << (int)std::get<Rgb>(color).blue << ")";
-        return out;
-    }
-    if (std::holds_alternative<Rgba>(color)) {
-        out << "rgba(" << (int)std::get<Rgba>(color).red << "," << (int)std::get<Rgba>(color).green << "," << (int)std::get<Rgba>(color).blue << ","
-        << (double)std::get<Rgba>(color).opacity << ")";
-        return out;
-    }
-    return out;
-}  
+    std::string text;
+    detail::AppendValue(text, color);
+    return out << text;
+}
 
 
 void Object::Render(const RenderContext& context) const {
     context.RenderIndent();
     // Делегируем вывод тега своим подклассам
-    RenderObject(context);
-
-    context.out << std::endl;
-}    
+    std::string text;
+    RenderTo(text);
+    text.push_back('\n');
+    context.out << text;
+}
 
 // ---------- Circle ------------------
 
@@ -91,40 +137,72 @@ Circle& Circle::SetRadius(double radius)  {
     return *this;
 }
 
-void Circle::RenderObject(const RenderContext& context) const {
-    auto& out = context.out;
-    out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
-    out << "r=\""sv << radius_ << "\" "sv;
-    RenderAttrs(context.out);    
-    out << "/>"sv;
+void Circle::RenderTo(std::string& out) const {
+    using detail::AppendValue;
+    out.append("<circle cx=\""sv);
+    AppendValue(out, center_.x);
+    out.append("\" cy=\""sv);
+    AppendValue(out, center_.y);
+    out.push_back('"');
+    if (const Style* style = GetStyle()) {
+        out.append(style->GetText());
+    } else {
+        RenderOwnStyle(out);
+    }
+    out.append("/>"sv);
+}
+
+Style Circle::MakeStyle() const {
+    std::string text;
+    RenderOwnStyle(text);
+    return Style(std::move(text));
 }
-    
+
+void Circle::RenderOwnStyle(std::string& out) const {
+    out.append(" r=\""sv);
+    detail::AppendValue(out, radius_);
+    out.append("\" "sv);
+    RenderAttrs(out);
+}
+
 // ---------- Polyline ------------------
-    
+
 Polyline& Polyline::AddPoint(Point point) {
     points_.push_back(point);
     return *this;
 }
-    
-void Polyline::RenderObject(const RenderContext& context) const {
-    auto& out = context.out;
-    out << "<polyline points=\""s;
+
+void Polyline::RenderTo(std::string& out) const {
+    using detail::AppendValue;
+    out.append("<polyline points=\""sv);
     bool is_first = true;
     for (Point point : points_) {
         if (is_first) {
-            out << point.x << "," << point.y;
             is_first = false;
         } else {
-            out << " " << point.x << "," << point.y;
+            out.push_back(' ');
         }
+        AppendValue(out, point.x);
+        out.push_back(',');
+        AppendValue(out, point.y);
     }
-    out << "\"";
-    RenderAttrs(context.out);
-    out << " />"s;
+    out.push_back('"');
+    if (const Style* style = GetStyle()) {
+        out.append(style->GetText());
+    } else {
+        RenderAttrs(out);
+    }
+    out.append(" />"sv);
+}
+
+Style Polyline::MakeStyle() const {
+    std::string text;
+    RenderAttrs(text);
+    return Style(std::move(text));
 }
-    
+
 // ---------- Text ------------------
-    
+
 Text& Text::SetPosition(Point pos) {
     position_ = pos;
     return *this;
@@ -140,78 +218,111 @@ Text& Text::SetFontSize(uint32_t size) {
     size_ = size;
     return *this;
 }
-    
+
     // Задаёт название шрифта (атрибут font-family)
 Text& Text::SetFontFamily(std::string font_family) {
-    font_family_ = font_family;
+    font_family_ = std::move(font_family);
     return *this;
 }
 
     // Задаёт толщину шрифта (атрибут font-weight)
 Text& Text::SetFontWeight(std::string font_weight) {
-    font_weight_ = font_weight;
+    font_weight_ = std::move(font_weight);
     return *this;
 }
 
     // Задаёт текстовое содержимое объекта (отображается внутри тега text)
 Text& Text::SetData(std::string data) {
-    data_ = data;
+    data_ = std::move(data);
     return *this;
 }
 
-void Text::RenderObject(const RenderContext& context) const {
-    auto& out = context.out;
-    out << "<text x=\"" << position_.x << "\" y=\"" << position_.y << "\" dx=\"" << offset_.x << "\" dy=\"" << offset_.y
-        << "\" font-size=\"" << size_ << "\"";
+void Text::RenderTo(std::string& out) const {
+    using detail::AppendValue;
+    out.append("<text x=\""sv);
+    AppendValue(out, position_.x);
+    out.append("\" y=\""sv);
+    AppendValue(out, position_.y);
+    out.push_back('"');
+    if (const Style* style = GetStyle()) {
+        out.append(style->GetText());
+    } else {
+        RenderOwnStyle(out);
+    }
+    out.push_back('>');
+    for (char symbol : data_) {
+        switch (symbol) {
+            case '\"':
+                out.append("&quot;"sv);
+                break;
+            case '<':
+                out.append("&lt;"sv);
+                break;
+            case '>':
+                out.append("&gt;"sv);
+                break;
+            case '\'':
+                out.append("&apos;"sv);
+                break;
+            case '&':
+                out.append("&amp;"sv);
+                break;
+            default:
+                out.push_back(symbol);
+                break;
+        }
+    }
+    out.append("</text>"sv);
+}
+
+Style Text::MakeStyle() const {
+    std::string text;
+    RenderOwnStyle(text);
+    return Style(std::move(text));
+}
+
+void Text::RenderOwnStyle(std::string& out) const {
+    using detail::AppendValue;
+    out.append(" dx=\""sv);
+    AppendValue(out, offset_.x);
+    out.append("\" dy=\""sv);
+    AppendValue(out, offset_.y);
+    out.append("\" font-size=\""sv);
+    AppendValue(out, size_);
+    out.push_back('"');
     if(!font_family_.empty()) {
-        out << " font-family=\"" << font_family_ << "\"";
+        out.append(" font-family=\""sv);
+        out.append(font_family_);
+        out.push_back('"');
     }
-    
+
     if(!font_weight_.empty()) {
-        out << " font-weight=\"" << font_weight_ << "\"";
+        out.append(" font-weight=\""sv);
+        out.append(font_weight_);
+        out.push_back('"');
     }
 
-    std::string data_correct_format;
-    for (char symbol : data_) {        
-        if (symbol == '\"') {
-            data_correct_format.append("&quot;");
-            continue;
-        }
-        if (symbol == '<') {
-            data_correct_format.append("&lt;");
-            continue;
-        }
-        if (symbol == '>') {
-            data_correct_format.append("&gt;");
-            continue;
-        }
-        if (symbol == '\'') {
-            data_correct_format.append("&apos;");
-            continue;
-        }
-        if (symbol == '&') {
-            data_correct_format.append("&amp;");
-            continue;
-        }
-        data_correct_format.append(1, symbol);        
-    }
-    RenderAttrs(context.out);
-    out << ">" << data_correct_format << "</text>";
+    RenderAttrs(out);
 }
 // ----------ContainerObject-------------
 void ObjectContainer::Render(std::ostream& out) const {
-    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl;
-    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
-    RenderContext context(out);
-    for (auto& object : objects_) {
-        out << "  ";
-        object->Render(context);
-    }
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv;
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv;
+    out << objects_text_;
     out << "</svg>"sv;
-}    
-    
+}
+
+void ObjectContainer::Render(std::string& out) const {
+    out.append("<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv);
+    out.append("<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv);
+    out.append(objects_text_);
+    out.append("</svg>"sv);
+}
+
 // ---------- Document ------------------
 void Document::AddPtr(std::unique_ptr<Object>&& obj) {
-    objects_.emplace_back(move(obj));
+    objects_text_.append("  ");
+    obj->RenderTo(objects_text_);
+    objects_text_.push_back('\n');
 }
-}  // namespace svg
\ No newline at end of file
+}  // namespace svg
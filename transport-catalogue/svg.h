@@ -5,27 +5,11 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
 namespace svg {
-    
-namespace detail {
-template <typename AttrType>
-inline void RenderAttr(std::ostream& out, std::string_view name, const AttrType& value) {
-    using namespace std::literals;
-    out << name << "=\""sv;
-    out << value;
-    out.put('"');
-}
-
-template <typename AttrType>
-inline void RenderOptionalAttr(std::ostream& out, std::string_view name, const std::optional<AttrType>& value) {
-    if (value) {
-        RenderAttr(out, name, *value);
-    }
-}    
-} // namespace detail
 
 struct Rgb {
     uint8_t red{};
@@ -71,6 +55,32 @@ struct Point {
     double y = 0;
 };
 
+namespace detail {
+// The values are appended as an ostream with the default format writes them,
+// numbers with 6 significant digits
+void AppendValue(std::string& out, double value);
+void AppendValue(std::string& out, uint32_t value);
+void AppendValue(std::string& out, const Color& color);
+void AppendValue(std::string& out, StrokeLineCap stroke_line_cap);
+void AppendValue(std::string& out, StrokeLineJoin stroke_line_join);
+
+template <typename AttrType>
+inline void RenderAttr(std::string& out, std::string_view name, const AttrType& value) {
+    using namespace std::literals;
+    out.append(name);
+    out.append("=\""sv);
+    AppendValue(out, value);
+    out.push_back('"');
+}
+
+template <typename AttrType>
+inline void RenderOptionalAttr(std::string& out, std::string_view name, const std::optional<AttrType>& value) {
+    if (value) {
+        RenderAttr(out, name, *value);
+    }
+}    
+} // namespace detail
+
 /*
  * Helper structure that stores the context for outputting the SVG document with indentation.
  * Stores a reference to the output stream, the current indentation level, and the indentation step
@@ -102,6 +112,26 @@ struct RenderContext {
     int indent = 0;
 };
 
+/*
+ * Attributes shared by many elements, rendered to text once by MakeStyle of an element
+ * set up with them. An element given the style by SetStyle writes this text in place of
+ * its own settings of those attributes, so the style must live until the element is added.
+ */
+class Style {
+public:
+    Style() = default;
+    explicit Style(std::string text)
+        : text_(std::move(text)) {
+    }
+
+    std::string_view GetText() const {
+        return text_;
+    }
+
+private:
+    std::string text_;
+};
+
 /*
  * Abstract base class Object serves for unified storage
  * of specific SVG document tags.
@@ -135,11 +165,20 @@ public:
         return AsOwner();
     }
 
+    Owner& SetStyle(const Style& style) {
+        style_ = &style;
+        return AsOwner();
+    }
+
 protected:
     ~PathProps() = default;
 
-    // The RenderAttrs method outputs common attributes fill and stroke for all paths to the stream.
-    void RenderAttrs(std::ostream& out) const {
+    const Style* GetStyle() const {
+        return style_;
+    }
+
+    // The RenderAttrs method appends common attributes fill and stroke for all paths to the text.
+    void RenderAttrs(std::string& out) const {
         using detail::RenderOptionalAttr;
         using namespace std::literals;
         RenderOptionalAttr(out, " fill"sv, fill_color_);
@@ -161,45 +200,71 @@ private:
     std::optional<double> width_;
     std::optional <StrokeLineCap> line_cap_;
     std::optional <StrokeLineJoin> line_join_;
+    const Style* style_ = nullptr;
 };
     
 class Object {
 public:    
+    // Outputs the tag with the indentation of the context and a line break
     void Render(const RenderContext& context) const;
+    // Appends the tag alone to the text
+    virtual void RenderTo(std::string& out) const = 0;
     virtual ~Object() = default;
-    
-private:
-    virtual void RenderObject(const RenderContext& context) const = 0;
 };
 
 class Circle final : public Object, public PathProps<Circle> {
 public:
     Circle& SetCenter(Point center);
     Circle& SetRadius(double radius);
+    void RenderTo(std::string& out) const override;
+    // The radius and the path attributes
+    Style MakeStyle() const;
 
 private:
-    void RenderObject(const RenderContext& context) const override;
+    void RenderOwnStyle(std::string& out) const;
 
     Point center_;
     double radius_ = 1.0;
 };
     
+/*
+ * Keeps the text of the objects rather than the objects: every object is written
+ * to a growing buffer as soon as it is added, in the order of adding.
+ */
 class ObjectContainer {
 public:
     
+    // The object types are final, so rendering them needs no virtual call
     template <typename Obj>
-    void Add(Obj obj) {
-        objects_.emplace_back(std::make_unique<Obj>(std::move(obj)));
+    void Add(const Obj& obj) {
+        objects_text_.append("  ");
+        obj.RenderTo(objects_text_);
+        objects_text_.push_back('\n');
     }   
     
     virtual void AddPtr(std::unique_ptr<Object>&& obj) = 0;
+
+    // Adds the objects of the containers from first up to last after these, in their order
+    template <typename ContainerIt>
+    void AddAll(ContainerIt first, ContainerIt last) {
+        size_t size = objects_text_.size();
+        for (ContainerIt it = first; it != last; ++it) {
+            size += static_cast<const ObjectContainer&>(*it).objects_text_.size();
+        }
+        objects_text_.reserve(size);
+        for (ContainerIt it = first; it != last; ++it) {
+            objects_text_.append(static_cast<const ObjectContainer&>(*it).objects_text_);
+        }
+    }
     
     // Outputs the SVG representation of the document to the ostream.
     void Render(std::ostream& out) const;
+    // Appends the SVG representation of the document to the text.
+    void Render(std::string& out) const;
 
     virtual ~ObjectContainer() {}
 protected:
-    std::vector<std::unique_ptr<Object>> objects_;
+    std::string objects_text_;
 };
         
 class Drawable {
@@ -211,8 +276,10 @@ public:
 class Polyline final : public Object, public PathProps<Polyline> {
 public:    
     Polyline& AddPoint(Point point);
+    void RenderTo(std::string& out) const override;
+    // The path attributes
+    Style MakeStyle() const;
 private:
-    void RenderObject(const RenderContext& context) const override;    
     std::vector<Point> points_;
 };
 
@@ -236,9 +303,13 @@ public:
     // Sets the text content of the object (displayed inside the text tag)
     Text& SetData(std::string data);
 
+    void RenderTo(std::string& out) const override;
+    // Everything but the position and the data
+    Style MakeStyle() const;
+
 private:
-    void RenderObject(const RenderContext& context) const override;
-    
+    void RenderOwnStyle(std::string& out) const;
+
     Point position_;
     Point offset_;
     uint32_t size_ = 1;
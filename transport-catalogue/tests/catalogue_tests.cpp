@@ -0,0 +1,81 @@
+#include "tests/test_runner.h"
+
+#include "json.h"
+#include "json_reader.h"
+#include "transport_catalogue.h"
+
+#include <sstream>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+
+namespace tests {
+
+namespace {
+
+// Stop A names a stop that is not in base_requests
+const std::string UNKNOWN_STOP_INPUT = R"({
+    "base_requests": [
+        {"type": "Stop", "name": "A", "latitude": 55.6, "longitude": 37.2,
+         "road_distances": {"B": 1000, "Nowhere": 500}},
+        {"type": "Stop", "name": "B", "latitude": 55.59, "longitude": 37.21,
+         "road_distances": {"A": 1200}},
+        {"type": "Bus", "name": "1", "stops": ["A", "B"], "is_roundtrip": false}
+    ]
+})";
+
+void CheckUnknownStopCatalogue(const TransportCatalogue& catalogue) {
+    ASSERT_EQUAL(catalogue.GetStopsCount(), 2);
+    ASSERT(catalogue.FindStop("Nowhere"sv) == nullptr);
+    ASSERT_EQUAL(catalogue.GetDistance(catalogue.FindStop("A"sv), catalogue.FindStop("B"sv)), 1000);
+    const std::optional<BusInfo> bus_info = catalogue.GetBusInfo("1"sv);
+    ASSERT(bus_info.has_value());
+    ASSERT_EQUAL(bus_info->route_length, 2200);
+}
+
+void TestDistanceToUnknownStopStreaming() {
+    TransportCatalogue catalogue;
+    JSONReader reader(UNKNOWN_STOP_INPUT, catalogue);
+    reader.FillCatalogue(catalogue);
+    CheckUnknownStopCatalogue(catalogue);
+}
+
+void TestDistanceToUnknownStopDocument() {
+    std::istringstream input(UNKNOWN_STOP_INPUT);
+    JSONReader reader(json::Load(input));
+    TransportCatalogue catalogue;
+    reader.FillCatalogue(catalogue);
+    CheckUnknownStopCatalogue(catalogue);
+}
+
+void TestDistanceToUnknownStopParsedInput() {
+    JSONReader reader(std::string_view{UNKNOWN_STOP_INPUT});
+    TransportCatalogue catalogue;
+    reader.FillCatalogue(catalogue);
+    CheckUnknownStopCatalogue(catalogue);
+}
+
+void TestSetDistanceIgnoresMissingStop() {
+    TransportCatalogue catalogue;
+    catalogue.AddStop("A"sv, {55.6, 37.2});
+    Stop* a = catalogue.FindStop("A"sv);
+    catalogue.SetDistance(a, catalogue.FindStop("Nowhere"sv), 100);
+    catalogue.SetDistance(catalogue.FindStop("Nowhere"sv), a, 100);
+    int distance_count = 0;
+    catalogue.ForEachDistance([&distance_count](const Stop*, const Stop*, int) {
+        ++distance_count;
+    });
+    ASSERT_EQUAL(distance_count, 0);
+}
+
+} // namespace
+
+void RunCatalogueTests(TestRunner& tr) {
+    RUN_TEST(tr, TestDistanceToUnknownStopStreaming);
+    RUN_TEST(tr, TestDistanceToUnknownStopDocument);
+    RUN_TEST(tr, TestDistanceToUnknownStopParsedInput);
+    RUN_TEST(tr, TestSetDistanceIgnoresMissingStop);
+}
+
+} // namespace tests
@@ -0,0 +1,82 @@
+#include "tests/test_runner.h"
+
+#include "json.h"
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "thread_pool.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std::literals;
+
+namespace tests {
+
+namespace {
+
+const std::string ERROR_INPUT = R"({
+    "base_requests": [
+        {"type": "Stop", "name": "A", "latitude": 55.6, "longitude": 37.2, "road_distances": {"B": 1000}},
+        {"type": "Stop", "name": "B", "latitude": 55.59, "longitude": 37.21, "road_distances": {}},
+        {"type": "Bus", "name": "1", "stops": ["A", "B"], "is_roundtrip": false}
+    ],
+    "render_settings": {
+        "width": 200, "height": 200, "padding": 30, "stop_radius": 5, "line_width": 14,
+        "bus_label_font_size": 20, "bus_label_offset": [7, 15], "stop_label_font_size": 20,
+        "stop_label_offset": [7, -3], "underlayer_color": "white",
+        "underlayer_width": 3, "color_palette": ["green"]
+    },
+    "routing_settings": {"bus_wait_time": 2, "bus_velocity": 30},
+    "stat_requests": [
+        {"id": 1, "type": "Route", "from": "A", "to": "Nowhere"},
+        {"id": 2, "type": "Bus", "name": "1"},
+        {"id": 3, "type": "Route", "from": "A"},
+        {"id": 4, "type": "Route", "from": "A", "to": "B"}
+    ]
+})";
+
+// Answers the stat requests of input like the program does
+json::Document Answer(const std::string& input, size_t thread_count) {
+    TransportCatalogue catalogue;
+    JSONReader reader(input, catalogue);
+    reader.FillCatalogue(catalogue);
+    TransportRouter router(catalogue, reader.GetRoutingSettings());
+    renderer::MapRenderer renderer(reader.GetRenderSettings());
+    RequestHandler handler(catalogue, renderer);
+    renderer.SetBusesToRender(handler.GetAllRoutesWithInfo());
+    reader.SetTransportRouter(&router);
+
+    std::ostringstream out;
+    {
+        parallel::ThreadPool pool(thread_count);
+        json::Writer writer(out);
+        reader.WriteAnswers(catalogue, handler, writer, pool);
+    }
+    std::istringstream answers(out.str());
+    return json::Load(answers);
+}
+
+void TestFailedRequestsAnswerNotFound() {
+    for (size_t thread_count : {1, 3}) {
+        const json::Array answers = Answer(ERROR_INPUT, thread_count).GetRoot().AsArray();
+        ASSERT_EQUAL(answers.size(), 4u);
+        for (int i : {0, 2}) {
+            const json::Dict& answer = answers[i].AsDict();
+            ASSERT_EQUAL(answer.at("request_id"s).AsInt(), i + 1);
+            ASSERT_EQUAL(answer.at("error_message"s).AsString(), "not found"s);
+        }
+        ASSERT_EQUAL(answers[1].AsDict().at("route_length"s).AsInt(), 2000);
+        ASSERT_EQUAL(answers[3].AsDict().at("total_time"s).AsDouble(), 4.0);
+    }
+}
+
+} // namespace
+
+void RunJsonReaderTests(TestRunner& tr) {
+    RUN_TEST(tr, TestFailedRequestsAnswerNotFound);
+}
+
+} // namespace tests
@@ -0,0 +1,313 @@
+#include "tests/random_json.h"
+#include "tests/test_runner.h"
+
+#include "json.h"
+#include "json_arena.h"
+#include "json_builder.h"
+
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace tests {
+
+namespace {
+
+json::Document LoadText(const std::string& text) {
+    std::istringstream input(text);
+    return json::Load(input);
+}
+
+std::string PrintText(const json::Document& doc) {
+    std::ostringstream out;
+    json::Print(doc, out);
+    return out.str();
+}
+
+// Rewrites the events of json::Parse with json::Writer
+std::string ParseAndWrite(const std::string& text, json::PrintMode mode = json::PrintMode::PRETTY) {
+    std::ostringstream out;
+    {
+        json::Writer writer(out, mode);
+        json::Parse(text, writer);
+    }
+    return out.str();
+}
+
+// The message of the ParsingError thrown by func, empty if it throws none
+template <typename Func>
+std::string GetParsingError(Func func) {
+    try {
+        func();
+    } catch (const json::ParsingError& e) {
+        return e.what();
+    }
+    return {};
+}
+
+// Builds a json::Node from the events of json::Parse
+class TreeHandler final : public json::Handler {
+public:
+    json::Node Build() {
+        return builder_.Build();
+    }
+
+    void StartDict() override {
+        builder_.StartDict();
+    }
+
+    void Key(std::string_view key) override {
+        builder_.Key(std::string(key));
+    }
+
+    void EndDict() override {
+        builder_.EndDict();
+    }
+
+    void StartArray() override {
+        builder_.StartArray();
+    }
+
+    void EndArray() override {
+        builder_.EndArray();
+    }
+
+    void String(std::string_view value) override {
+        builder_.Value(std::string(value));
+    }
+
+    void Int(int value) override {
+        builder_.Value(value);
+    }
+
+    void Double(double value) override {
+        builder_.Value(value);
+    }
+
+    void Bool(bool value) override {
+        builder_.Value(value);
+    }
+
+    void Null() override {
+        builder_.Value(nullptr);
+    }
+
+private:
+    json::Builder builder_;
+};
+
+json::Node ToNode(const json::arena::Node& node) {
+    if (node.IsNull()) {
+        return json::Node(nullptr);
+    }
+    if (node.IsBool()) {
+        return json::Node(node.AsBool());
+    }
+    if (node.IsInt()) {
+        return json::Node(node.AsInt());
+    }
+    if (node.IsDouble()) {
+        return json::Node(node.AsDouble());
+    }
+    if (node.IsString()) {
+        return json::Node(std::string(node.AsString()));
+    }
+    if (node.IsArray()) {
+        json::Array array;
+        for (const json::arena::Node& item : node.AsArray()) {
+            array.push_back(ToNode(item));
+        }
+        return json::Node(std::move(array));
+    }
+    json::Dict dict;
+    for (const json::arena::Member& member : node.AsDict()) {
+        // the members are sorted, so every key is found by the binary search
+        if (node.AsDict().Find(member.key) != &member.value) {
+            throw std::logic_error("Member "s + std::string(member.key) + " is not found"s);
+        }
+        dict.emplace(std::string(member.key), ToNode(member.value));
+    }
+    return json::Node(std::move(dict));
+}
+
+const std::vector<std::string> BAD_DOCUMENTS = {
+    "", "[1, 2", "{\"a\": 1", "{\"a\": 1, \"a\": 2}", "tru", "nul", "\"abc", "\"a\nb\"", "\"\\x\"",
+    "1.", "-", "1e", "{\"a\" 1}", "{1: 2}", "1e400", "[1,, 2]x",
+};
+
+void TestLoadValues() {
+    const json::Document doc = LoadText(R"({"a": [1, -2.5, 1e3, true, false, null, "s\"\\\n\t"], "b": {}})");
+    const json::Dict& root = doc.GetRoot().AsDict();
+    const json::Array& a = root.at("a"s).AsArray();
+    ASSERT_EQUAL(a.size(), 7u);
+    ASSERT_EQUAL(a[0].AsInt(), 1);
+    ASSERT(a[1].IsPureDouble());
+    ASSERT_EQUAL(a[1].AsDouble(), -2.5);
+    ASSERT_EQUAL(a[2].AsDouble(), 1000.0);
+    ASSERT(a[3].AsBool());
+    ASSERT(!a[4].AsBool());
+    ASSERT(a[5].IsNull());
+    ASSERT_EQUAL(a[6].AsString(), "s\"\\\n\t"s);
+    ASSERT(root.at("b"s).AsDict().empty());
+}
+
+void TestLoadNumbers() {
+    const json::Array numbers = LoadText("[2147483647, -2147483648, 2147483648, 0.1, -0, 1E-2, 4.9e-324]")
+                                    .GetRoot().AsArray();
+    ASSERT_EQUAL(numbers[0].AsInt(), 2147483647);
+    ASSERT_EQUAL(numbers[1].AsInt(), -2147483647 - 1);
+    // an int that does not fit becomes a double
+    ASSERT(numbers[2].IsPureDouble());
+    ASSERT_EQUAL(numbers[2].AsDouble(), 2147483648.0);
+    ASSERT_EQUAL(numbers[3].AsDouble(), 0.1);
+    ASSERT(numbers[4].IsInt());
+    ASSERT_EQUAL(numbers[5].AsDouble(), 0.01);
+    ASSERT(numbers[6].AsDouble() > 0.0);
+}
+
+// What the number literal reads as with strtoll and strtod: an int when it has no fraction or
+// exponent and fits, otherwise a double, and nothing for a double out of range
+std::optional<json::Node> ConvertWithStrtod(const std::string& text) {
+    if (text.find_first_of(".eE"s) == std::string::npos) {
+        errno = 0;
+        const long long value = std::strtoll(text.c_str(), nullptr, 10);
+        if (errno == 0 && value >= INT_MIN && value <= INT_MAX) {
+            return json::Node(static_cast<int>(value));
+        }
+    }
+    errno = 0;
+    const double value = std::strtod(text.c_str(), nullptr);
+    // strtod reports ERANGE for subnormal results as well, which are accepted
+    if (errno == ERANGE && (std::isinf(value) || value == 0.0)) {
+        return std::nullopt;
+    }
+    return json::Node(value);
+}
+
+void TestNumbersMatchStrtod() {
+    RandomJson random_json(13);
+    for (int i = 0; i < 200000; ++i) {
+        const std::string text = random_json.MakeNumber();
+        const std::optional<json::Node> expected = ConvertWithStrtod(text);
+        if (!expected) {
+            ASSERT_EQUAL(GetParsingError([&text] { LoadText(text); }), "Failed to convert "s + text + " to number"s);
+            continue;
+        }
+        const json::Node found = LoadText(text).GetRoot();
+        ASSERT_EQUAL(found.IsInt(), expected->IsInt());
+        if (found.IsInt()) {
+            ASSERT_EQUAL(found.AsInt(), expected->AsInt());
+        } else {
+            // bit-identical, not only close
+            const double found_value = found.AsDouble();
+            const double expected_value = expected->AsDouble();
+            ASSERT(std::memcmp(&found_value, &expected_value, sizeof(double)) == 0);
+        }
+    }
+}
+
+void TestLoadErrors() {
+    for (const std::string& text : BAD_DOCUMENTS) {
+        ASSERT(!GetParsingError([&text] { LoadText(text); }).empty());
+    }
+    ASSERT_EQUAL(GetParsingError([] { LoadText(R"({"a": 1, "a": 2})"); }), "Duplicate key 'a' have been found"s);
+}
+
+void TestParseMatchesLoad() {
+    // the keys are sorted, so Writer and Print give the same text
+    const std::string text = R"({"a": [1, -2.5, {"x": "y\n"}, [], {}], "b": null, "c": [true, false, "\\"]})";
+    ASSERT_EQUAL(ParseAndWrite(text), PrintText(LoadText(text)));
+    ASSERT_EQUAL(ParseAndWrite(text, json::PrintMode::COMPACT),
+                 R"({"a":[1,-2.5,{"x":"y\n"},[],{}],"b":null,"c":[true,false,"\\"]})"s);
+
+    for (const std::string& text : BAD_DOCUMENTS) {
+        // a bad document may still have started some values, the writer is left unfinished
+        const std::string parse_error = GetParsingError([&text] {
+            std::ostringstream out;
+            json::Writer writer(out);
+            json::Parse(text, writer);
+        });
+        ASSERT_EQUAL(parse_error, GetParsingError([&text] { LoadText(text); }));
+    }
+}
+
+void TestParseMatchesLoadOnRandomDocuments() {
+    RandomJson random_json(14);
+    int valid_count = 0;
+    for (int i = 0; i < 50000; ++i) {
+        const std::string text = i % 2 == 0 ? random_json.MakeDocument() : random_json.MakeMutatedDocument();
+        std::optional<json::Node> loaded;
+        const std::string load_error = GetParsingError([&] { loaded = LoadText(text).GetRoot(); });
+        std::optional<json::Node> parsed;
+        const std::string parse_error = GetParsingError([&] {
+            TreeHandler handler;
+            json::Parse(text, handler);
+            parsed = handler.Build();
+        });
+        ASSERT_EQUAL(parse_error, load_error);
+        if (load_error.empty()) {
+            ASSERT(*parsed == *loaded);
+            ++valid_count;
+        }
+    }
+    // most mutated documents are broken, but not all of them
+    ASSERT(valid_count > 25000);
+}
+
+void TestArenaNodesMatchLoadOnRandomDocuments() {
+    RandomJson random_json(15);
+    // one arena for many documents, like the streaming reader keeps it
+    std::pmr::monotonic_buffer_resource arena;
+    int valid_count = 0;
+    for (int i = 0; i < 50000; ++i) {
+        const std::string text = i % 2 == 0 ? random_json.MakeDocument() : random_json.MakeMutatedDocument();
+        if (i % 1000 == 0) {
+            arena.release();
+        }
+        std::optional<json::Node> loaded;
+        const std::string load_error = GetParsingError([&] { loaded = LoadText(text).GetRoot(); });
+        json::arena::Builder builder(arena, text);
+        const std::string parse_error = GetParsingError([&] { json::Parse(text, builder); });
+        ASSERT_EQUAL(parse_error, load_error);
+        if (load_error.empty()) {
+            ASSERT(builder.IsComplete());
+            ASSERT(ToNode(builder.GetRoot()) == *loaded);
+            ++valid_count;
+        }
+    }
+    ASSERT(valid_count > 25000);
+}
+
+void TestWriterRejectsMisplacedEvents() {
+    std::ostringstream out;
+    json::Writer writer(out);
+    writer.StartArray();
+    ASSERT_THROWS(writer.Key("a"sv), std::logic_error);
+    ASSERT_THROWS(writer.EndDict(), std::logic_error);
+}
+
+} // namespace
+
+void RunJsonTests(TestRunner& tr) {
+    RUN_TEST(tr, TestLoadValues);
+    RUN_TEST(tr, TestLoadNumbers);
+    RUN_TEST(tr, TestNumbersMatchStrtod);
+    RUN_TEST(tr, TestLoadErrors);
+    RUN_TEST(tr, TestParseMatchesLoad);
+    RUN_TEST(tr, TestParseMatchesLoadOnRandomDocuments);
+    RUN_TEST(tr, TestArenaNodesMatchLoadOnRandomDocuments);
+    RUN_TEST(tr, TestWriterRejectsMisplacedEvents);
+}
+
+} // namespace tests
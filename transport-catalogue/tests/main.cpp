@@ -0,0 +1,25 @@
+#include "tests/test_runner.h"
+
+namespace tests {
+
+void RunCatalogueTests(TestRunner& tr);
+void RunJsonReaderTests(TestRunner& tr);
+void RunJsonTests(TestRunner& tr);
+void RunRouterTests(TestRunner& tr);
+void RunSerializationTests(TestRunner& tr);
+
+} // namespace tests
+
+int main() {
+    tests::TestRunner tr;
+    tests::RunCatalogueTests(tr);
+    tests::RunJsonTests(tr);
+    tests::RunJsonReaderTests(tr);
+    tests::RunRouterTests(tr);
+    tests::RunSerializationTests(tr);
+    if (tr.GetFailCount() > 0) {
+        std::cerr << tr.GetFailCount() << " unit tests failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace tests {
+
+// Random JSON texts for differential tests of the parsers: valid documents made of every kind
+// of value and copies of them with a few characters inserted, removed or replaced
+class RandomJson {
+public:
+    explicit RandomJson(unsigned seed)
+        : random_(seed) {
+    }
+
+    std::string MakeDocument() {
+        std::string text;
+        AddValue(text, 0);
+        return text;
+    }
+
+    // A document broken in a few places, most of them are no longer valid
+    std::string MakeMutatedDocument() {
+        std::string text = MakeDocument();
+        const int mutation_count = 1 + Random(3);
+        for (int i = 0; i < mutation_count && !text.empty(); ++i) {
+            const size_t position = Random(static_cast<int>(text.size()));
+            switch (Random(3)) {
+                case 0:
+                    text.erase(position, 1);
+                    break;
+                case 1:
+                    text.insert(position, 1, RandomChar());
+                    break;
+                default:
+                    text[position] = RandomChar();
+                    break;
+            }
+        }
+        return text;
+    }
+
+    // A number literal, sometimes beyond the range of int or double
+    std::string MakeNumber() {
+        std::string text;
+        if (Random(2) == 0) {
+            text += '-';
+        }
+        AddDigits(text, 1 + Random(Random(4) == 0 ? 25 : 10));
+        if (Random(2) == 0) {
+            text += '.';
+            AddDigits(text, 1 + Random(20));
+        }
+        if (Random(3) == 0) {
+            text += "eE"[Random(2)];
+            if (Random(2) == 0) {
+                text += "+-"[Random(2)];
+            }
+            AddDigits(text, 1 + Random(3));
+        }
+        return text;
+    }
+
+private:
+    static constexpr int MAX_DEPTH = 4;
+
+    int Random(int bound) {
+        return std::uniform_int_distribution<int>(0, bound - 1)(random_);
+    }
+
+    char RandomChar() {
+        static constexpr std::string_view CHARS = "{}[]:,\"\\ntfu0123456789.-+eE \n\t";
+        return CHARS[Random(static_cast<int>(CHARS.size()))];
+    }
+
+    void AddDigits(std::string& text, int count) {
+        // no leading zeros, which JSON does not allow
+        text += static_cast<char>('1' + Random(9));
+        for (int i = 1; i < count; ++i) {
+            text += static_cast<char>('0' + Random(10));
+        }
+    }
+
+    void AddSpace(std::string& text) {
+        static constexpr std::string_view SPACES[] = {"", "", " ", "\n  ", "\t"};
+        text += SPACES[Random(5)];
+    }
+
+    void AddString(std::string& text) {
+        static constexpr std::string_view PARTS[] = {"a", "Stop", " ", "\\n", "\\t", "\\r", "\\\"", "\\\\", "z9",
+                                                     "\xd0\x9c"};
+        text += '"';
+        for (int i = Random(6); i > 0; --i) {
+            text += PARTS[Random(10)];
+        }
+        text += '"';
+    }
+
+    void AddValue(std::string& text, int depth) {
+        AddSpace(text);
+        const int kind = Random(depth < MAX_DEPTH ? 8 : 6);
+        switch (kind) {
+            case 0:
+                text += "null";
+                break;
+            case 1:
+                text += Random(2) == 0 ? "true" : "false";
+                break;
+            case 2:
+                [[fallthrough]];
+            case 3:
+                text += MakeNumber();
+                break;
+            case 4:
+                [[fallthrough]];
+            case 5:
+                AddString(text);
+                break;
+            case 6: {
+                text += '[';
+                for (int i = Random(5); i > 0; --i) {
+                    AddValue(text, depth + 1);
+                    AddSpace(text);
+                    if (i > 1) {
+                        text += ',';
+                    }
+                }
+                text += ']';
+                break;
+            }
+            default: {
+                // keys are taken from a small set, so some dicts get a duplicate key
+                text += '{';
+                for (int i = Random(5); i > 0; --i) {
+                    AddSpace(text);
+                    text += "\"k" + std::to_string(Random(6)) + (Random(8) == 0 ? "\\n" : "") + '"';
+                    AddSpace(text);
+                    text += ':';
+                    AddValue(text, depth + 1);
+                    AddSpace(text);
+                    if (i > 1) {
+                        text += ',';
+                    }
+                }
+                text += '}';
+                break;
+            }
+        }
+    }
+
+    std::mt19937 random_;
+};
+
+} // namespace tests
@@ -0,0 +1,195 @@
+#include "tests/test_runner.h"
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+using transport_catalogue::TransportCatalogue;
+
+namespace tests {
+
+namespace {
+
+const RouterType ROUTER_TYPES[] = {RouterType::ALL_PAIRS, RouterType::ALL_PAIRS_FLAT, RouterType::DIJKSTRA,
+                                   RouterType::CONTRACTION_HIERARCHY};
+const GraphModel GRAPH_MODELS[] = {GraphModel::SPANS, GraphModel::RIDE_CHAIN};
+
+std::vector<Stop*> FindStops(const TransportCatalogue& catalogue, const std::vector<std::string>& names) {
+    std::vector<Stop*> stops;
+    for (const std::string& name : names) {
+        stops.push_back(catalogue.FindStop(name));
+    }
+    return stops;
+}
+
+// A, B and C on bus 1 and C, D on bus 2, both not round
+void FillSmallCatalogue(TransportCatalogue& catalogue) {
+    for (const std::string& name : {"A"s, "B"s, "C"s, "D"s, "E"s}) {
+        catalogue.AddStop(name, {55.6, 37.6});
+    }
+    catalogue.SetDistance(catalogue.FindStop("A"sv), catalogue.FindStop("B"sv), 1000);
+    catalogue.SetDistance(catalogue.FindStop("B"sv), catalogue.FindStop("C"sv), 2000);
+    catalogue.SetDistance(catalogue.FindStop("C"sv), catalogue.FindStop("D"sv), 500);
+    catalogue.AddBus("1"sv, FindStops(catalogue, {"A"s, "B"s, "C"s, "B"s, "A"s}), false);
+    catalogue.AddBus("2"sv, FindStops(catalogue, {"C"s, "D"s, "C"s}), false);
+    catalogue.Finalize();
+}
+
+void TestSmallNetworkRoutes() {
+    TransportCatalogue catalogue;
+    FillSmallCatalogue(catalogue);
+    for (const RouterType router_type : ROUTER_TYPES) {
+        for (const GraphModel graph_model : GRAPH_MODELS) {
+            // 1000 m a minute
+            const TransportRouter router(catalogue, RoutingSettings{2, 1000.0, router_type, graph_model, 1});
+
+            const RouteReqInfo a_to_d = router.GetRoutesInfo(catalogue.FindStop("A"sv), catalogue.FindStop("D"sv));
+            ASSERT(a_to_d.route_info.has_value());
+            ASSERT_EQUAL(a_to_d.total_time, 7.5);
+            const std::vector<ActivityInfo>& items = *a_to_d.route_info;
+            ASSERT_EQUAL(items.size(), 4u);
+            ASSERT_EQUAL(items[0].type, "Wait"s);
+            ASSERT_EQUAL(items[0].stop_name, "A"sv);
+            ASSERT_EQUAL(items[1].type, "Bus"s);
+            ASSERT_EQUAL(items[1].bus_name, "1"sv);
+            ASSERT_EQUAL(items[1].span_count, 2);
+            ASSERT_EQUAL(items[1].time, 3.0);
+            ASSERT_EQUAL(items[2].stop_name, "C"sv);
+            ASSERT_EQUAL(items[3].bus_name, "2"sv);
+            ASSERT_EQUAL(items[3].span_count, 1);
+            ASSERT_EQUAL(items[3].time, 0.5);
+
+            const RouteReqInfo b_to_b = router.GetRoutesInfo(catalogue.FindStop("B"sv), catalogue.FindStop("B"sv));
+            ASSERT(b_to_b.route_info.has_value());
+            ASSERT(b_to_b.route_info->empty());
+            ASSERT_EQUAL(b_to_b.total_time, 0.0);
+
+            // E has no buses
+            ASSERT(!router.GetRoutesInfo(catalogue.FindStop("A"sv), catalogue.FindStop("E"sv)).route_info);
+        }
+    }
+}
+
+// Stops on a grid with buses along random rows and columns, some of them round
+void FillRandomCatalogue(TransportCatalogue& catalogue, uint32_t seed) {
+    constexpr int SIDE = 8;
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> random_line(0, SIDE - 1);
+    std::uniform_int_distribution<int> random_distance(300, 700);
+    auto get_name = [](int x, int y) {
+        return "S"s + std::to_string(x) + "_"s + std::to_string(y);
+    };
+    for (int x = 0; x < SIDE; ++x) {
+        for (int y = 0; y < SIDE; ++y) {
+            catalogue.AddStop(get_name(x, y), {55.5 + x * 0.001, 37.4 + y * 0.001});
+        }
+    }
+    for (int x = 0; x < SIDE; ++x) {
+        for (int y = 0; y + 1 < SIDE; ++y) {
+            catalogue.SetDistance(catalogue.FindStop(get_name(x, y)), catalogue.FindStop(get_name(x, y + 1)),
+                                  random_distance(random));
+            catalogue.SetDistance(catalogue.FindStop(get_name(y, x)), catalogue.FindStop(get_name(y + 1, x)),
+                                  random_distance(random));
+        }
+    }
+    for (int bus = 0; bus < 12; ++bus) {
+        const bool is_row = random() % 2 == 0;
+        const int line = random_line(random);
+        const int first = random_line(random) / 2;
+        const int last = SIDE / 2 + random_line(random) / 2;
+        std::vector<std::string> names;
+        for (int i = first; i <= last; ++i) {
+            names.push_back(is_row ? get_name(line, i) : get_name(i, line));
+        }
+        const bool is_round = random() % 3 == 0;
+        // the stops of a bus that is not round are given there and back like the reader gives them,
+        // a round bus takes the same stops as a loop
+        for (int i = static_cast<int>(names.size()) - 2; i >= 0; --i) {
+            names.push_back(names[i]);
+        }
+        catalogue.AddBus("Bus "s + std::to_string(bus), FindStops(catalogue, names), is_round);
+    }
+    catalogue.Finalize();
+}
+
+double GetTotalTime(const RouteReqInfo& info) {
+    return info.route_info ? info.total_time : -1.0;
+}
+
+void TestEnginesAgreeOnRandomNetworks() {
+    for (uint32_t seed = 1; seed <= 3; ++seed) {
+        TransportCatalogue catalogue;
+        FillRandomCatalogue(catalogue, seed);
+        const TransportRouter expected_router(catalogue, RoutingSettings{3, 500.0, RouterType::ALL_PAIRS,
+                                                                         GraphModel::SPANS, 1});
+        for (const RouterType router_type : ROUTER_TYPES) {
+            for (const GraphModel graph_model : GRAPH_MODELS) {
+                const TransportRouter router(catalogue, RoutingSettings{3, 500.0, router_type, graph_model, 2});
+                for (const Stop& from : catalogue.GetStops()) {
+                    for (const Stop& to : catalogue.GetStops()) {
+                        const RouteReqInfo expected = expected_router.GetRoutesInfo(&from, &to);
+                        const RouteReqInfo found = router.GetRoutesInfo(&from, &to);
+                        const double expected_time = GetTotalTime(expected);
+                        ASSERT(std::abs(GetTotalTime(found) - expected_time) <= 1e-9 * std::max(1.0, expected_time));
+                        if (!found.route_info) {
+                            continue;
+                        }
+                        // the items add up to the total time
+                        double items_time = 0.0;
+                        for (const ActivityInfo& item : *found.route_info) {
+                            items_time += item.time;
+                        }
+                        ASSERT(std::abs(items_time - found.total_time) <= 1e-9 * std::max(1.0, items_time));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void TestFlatRouterMatchesAllPairs() {
+    TransportCatalogue catalogue;
+    FillRandomCatalogue(catalogue, 7);
+    const TransportRouter expected_router(catalogue, RoutingSettings{3, 500.0, RouterType::ALL_PAIRS,
+                                                                     GraphModel::SPANS, 1});
+    for (const size_t thread_count : {1, 3}) {
+        const TransportRouter router(catalogue, RoutingSettings{3, 500.0, RouterType::ALL_PAIRS_FLAT,
+                                                                GraphModel::SPANS, thread_count});
+        for (const Stop& from : catalogue.GetStops()) {
+            for (const Stop& to : catalogue.GetStops()) {
+                const RouteReqInfo expected = expected_router.GetRoutesInfo(&from, &to);
+                const RouteReqInfo found = router.GetRoutesInfo(&from, &to);
+                ASSERT_EQUAL(found.route_info.has_value(), expected.route_info.has_value());
+                if (!expected.route_info) {
+                    continue;
+                }
+                // the same routes, not only the same times
+                ASSERT_EQUAL(found.total_time, expected.total_time);
+                ASSERT_EQUAL(found.route_info->size(), expected.route_info->size());
+                for (size_t i = 0; i < expected.route_info->size(); ++i) {
+                    ASSERT_EQUAL((*found.route_info)[i].type, (*expected.route_info)[i].type);
+                    ASSERT_EQUAL((*found.route_info)[i].stop_name, (*expected.route_info)[i].stop_name);
+                    ASSERT_EQUAL((*found.route_info)[i].bus_name, (*expected.route_info)[i].bus_name);
+                    ASSERT_EQUAL((*found.route_info)[i].time, (*expected.route_info)[i].time);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+void RunRouterTests(TestRunner& tr) {
+    RUN_TEST(tr, TestSmallNetworkRoutes);
+    RUN_TEST(tr, TestEnginesAgreeOnRandomNetworks);
+    RUN_TEST(tr, TestFlatRouterMatchesAllPairs);
+}
+
+} // namespace tests
@@ -0,0 +1,215 @@
+#include "tests/test_runner.h"
+
+#include "json_reader.h"
+#include "serialization.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace std::literals;
+
+namespace tests {
+
+namespace {
+
+const std::string BASE_INPUT = R"({
+    "base_requests": [
+        {"type": "Bus", "name": "14", "stops": ["Liza", "Kiev", "Ship", "Liza"], "is_roundtrip": true},
+        {"type": "Stop", "name": "Liza", "latitude": 43.590317, "longitude": 39.746833,
+         "road_distances": {"Kiev": 7500, "Ship": 1800}},
+        {"type": "Stop", "name": "Kiev", "latitude": 43.598701, "longitude": 39.730623,
+         "road_distances": {"Ship": 2400}},
+        {"type": "Stop", "name": "Ship", "latitude": 43.581969, "longitude": 39.719848,
+         "road_distances": {"Liza": 1200}},
+        {"type": "Bus", "name": "24", "stops": ["Ship", "Kiev"], "is_roundtrip": false}
+    ],
+    "render_settings": {
+        "width": 200, "height": 200, "padding": 30, "stop_radius": 5, "line_width": 14,
+        "bus_label_font_size": 20, "bus_label_offset": [7, 15], "stop_label_font_size": 20,
+        "stop_label_offset": [7, -3], "underlayer_color": [255, 255, 255, 0.85],
+        "underlayer_width": 3, "color_palette": ["green", [255, 160, 0], "red"]
+    },
+    "routing_settings": {"bus_wait_time": 2, "bus_velocity": 30}
+})";
+
+// Offset of the router section in the header, after the magic, the version and two offsets
+constexpr size_t ROUTER_OFFSET_POSITION = 32;
+// Offset of the route tables in the header, after the router section offset
+constexpr size_t TABLES_OFFSET_POSITION = 40;
+// Wait time, velocity, router type and graph model precede the stop order in the router section
+constexpr size_t PLACE_COUNT_POSITION = 4 + 8 + 4 + 4;
+
+std::string GetBasePath() {
+    return (std::filesystem::temp_directory_path() / ("tc_test_"s + std::to_string(getpid()) + ".db"s)).string();
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void WriteFile(const std::string& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(content.data(), content.size());
+}
+
+// Makes a base for BASE_INPUT with the given routing settings and returns the answers to all routes
+std::vector<double> MakeBase(const std::string& path, const RoutingSettings& settings) {
+    TransportCatalogue catalogue;
+    JSONReader reader(BASE_INPUT, catalogue);
+    reader.FillCatalogue(catalogue);
+    TransportRouter router(catalogue, settings);
+    serialization::SaveBase(path, catalogue, reader.GetRenderSettings(), router);
+
+    std::vector<double> total_times;
+    for (const Stop& from : catalogue.GetStops()) {
+        for (const Stop& to : catalogue.GetStops()) {
+            total_times.push_back(router.GetRoutesInfo(&from, &to).total_time);
+        }
+    }
+    return total_times;
+}
+
+std::vector<double> AnswerFromBase(const std::string& path) {
+    const serialization::MappedBase base(path);
+    TransportCatalogue catalogue;
+    base.FillCatalogue(catalogue);
+    const std::unique_ptr<TransportRouter> router = base.MakeTransportRouter(catalogue);
+
+    std::vector<double> total_times;
+    for (const Stop& from : catalogue.GetStops()) {
+        for (const Stop& to : catalogue.GetStops()) {
+            total_times.push_back(router->GetRoutesInfo(&from, &to).total_time);
+        }
+    }
+    return total_times;
+}
+
+size_t GetPlacesPosition(const std::string& content) {
+    uint64_t router_offset = 0;
+    std::memcpy(&router_offset, content.data() + ROUTER_OFFSET_POSITION, sizeof(router_offset));
+    return router_offset + PLACE_COUNT_POSITION + sizeof(uint64_t);
+}
+
+void TestBaseRoundTrip() {
+    const std::string path = GetBasePath();
+    for (const RouterType router_type : {RouterType::ALL_PAIRS_FLAT, RouterType::DIJKSTRA}) {
+        for (const GraphModel graph_model : {GraphModel::SPANS, GraphModel::RIDE_CHAIN}) {
+            RoutingSettings settings{2, 30.0, router_type, graph_model, 1};
+            const std::vector<double> expected = MakeBase(path, settings);
+            ASSERT(AnswerFromBase(path) == expected);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+void TestBaseWithRepeatedStopPlace() {
+    const std::string path = GetBasePath();
+    MakeBase(path, RoutingSettings{2, 30.0, RouterType::DIJKSTRA, GraphModel::SPANS, 1});
+    std::string content = ReadFile(path);
+    const size_t places = GetPlacesPosition(content);
+    // the second place gets the stop of the first one
+    std::memcpy(content.data() + places + sizeof(uint32_t), content.data() + places, sizeof(uint32_t));
+    WriteFile(path, content);
+    ASSERT_THROWS(AnswerFromBase(path), serialization::SerializationError);
+    std::filesystem::remove(path);
+}
+
+void TestBaseWithUnknownStopPlace() {
+    const std::string path = GetBasePath();
+    MakeBase(path, RoutingSettings{2, 30.0, RouterType::DIJKSTRA, GraphModel::SPANS, 1});
+    std::string content = ReadFile(path);
+    const uint32_t stop_id = 3;
+    std::memcpy(content.data() + GetPlacesPosition(content), &stop_id, sizeof(stop_id));
+    WriteFile(path, content);
+    ASSERT_THROWS(AnswerFromBase(path), serialization::SerializationError);
+    std::filesystem::remove(path);
+}
+
+void TestBaseWithWrongVertexCount() {
+    const std::string path = GetBasePath();
+    MakeBase(path, RoutingSettings{2, 30.0, RouterType::DIJKSTRA, GraphModel::SPANS, 1});
+    std::string content = ReadFile(path);
+    // the vertex count follows the places of the three stops
+    const size_t vertex_count_position = GetPlacesPosition(content) + 3 * sizeof(uint32_t);
+    uint64_t vertex_count = 0;
+    std::memcpy(&vertex_count, content.data() + vertex_count_position, sizeof(vertex_count));
+    ASSERT_EQUAL(vertex_count, 6u);
+    ++vertex_count;
+    std::memcpy(content.data() + vertex_count_position, &vertex_count, sizeof(vertex_count));
+    WriteFile(path, content);
+    ASSERT_THROWS(AnswerFromBase(path), serialization::SerializationError);
+    std::filesystem::remove(path);
+}
+
+void TestBaseWithBrokenPrevEdges() {
+    const std::string path = GetBasePath();
+    MakeBase(path, RoutingSettings{2, 30.0, RouterType::ALL_PAIRS_FLAT, GraphModel::SPANS, 1});
+    std::string content = ReadFile(path);
+    uint64_t tables_offset = 0;
+    std::memcpy(&tables_offset, content.data() + TABLES_OFFSET_POSITION, sizeof(tables_offset));
+    ASSERT(tables_offset != 0);
+    // the predecessors of the 6 x 6 tables follow the weights and name edges that do not exist
+    const size_t cell_count = 6 * 6;
+    const uint32_t edge_id = 1000;
+    for (size_t cell = 0; cell < cell_count; ++cell) {
+        std::memcpy(content.data() + tables_offset + cell_count * sizeof(double) + cell * sizeof(uint32_t),
+                    &edge_id, sizeof(edge_id));
+    }
+    WriteFile(path, content);
+    ASSERT_THROWS(AnswerFromBase(path), std::out_of_range);
+    std::filesystem::remove(path);
+}
+
+void TestSaveBaseKeepsMappedBase() {
+    const std::string path = GetBasePath();
+    const std::vector<double> expected = MakeBase(path, RoutingSettings{2, 30.0, RouterType::ALL_PAIRS_FLAT,
+                                                                        GraphModel::SPANS, 1});
+    const serialization::MappedBase base(path);
+    // a base of another size and with other answers replaces the mapped one
+    const std::vector<double> new_expected = MakeBase(path, RoutingSettings{5, 30.0, RouterType::DIJKSTRA,
+                                                                            GraphModel::RIDE_CHAIN, 1});
+    ASSERT(new_expected != expected);
+
+    TransportCatalogue catalogue;
+    base.FillCatalogue(catalogue);
+    const std::unique_ptr<TransportRouter> router = base.MakeTransportRouter(catalogue);
+    std::vector<double> total_times;
+    for (const Stop& from : catalogue.GetStops()) {
+        for (const Stop& to : catalogue.GetStops()) {
+            total_times.push_back(router->GetRoutesInfo(&from, &to).total_time);
+        }
+    }
+    ASSERT(total_times == expected);
+    ASSERT(AnswerFromBase(path) == new_expected);
+
+    size_t file_count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::path(path).parent_path())) {
+        file_count += entry.path().filename().string().rfind(std::filesystem::path(path).filename().string(), 0) == 0;
+    }
+    ASSERT_EQUAL(file_count, 1u);
+    std::filesystem::remove(path);
+}
+
+} // namespace
+
+void RunSerializationTests(TestRunner& tr) {
+    RUN_TEST(tr, TestBaseRoundTrip);
+    RUN_TEST(tr, TestBaseWithRepeatedStopPlace);
+    RUN_TEST(tr, TestBaseWithUnknownStopPlace);
+    RUN_TEST(tr, TestBaseWithWrongVertexCount);
+    RUN_TEST(tr, TestBaseWithBrokenPrevEdges);
+    RUN_TEST(tr, TestSaveBaseKeepsMappedBase);
+}
+
+} // namespace tests
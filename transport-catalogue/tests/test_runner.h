@@ -0,0 +1,70 @@
+#pragma once
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace tests {
+
+// Runs test functions and counts the failed ones, a failed check throws std::runtime_error
+class TestRunner {
+public:
+    template <typename TestFunc>
+    void RunTest(TestFunc func, const std::string& test_name) {
+        try {
+            func();
+            std::cerr << test_name << " OK" << std::endl;
+        } catch (const std::exception& e) {
+            ++fail_count_;
+            std::cerr << test_name << " fail: " << e.what() << std::endl;
+        } catch (...) {
+            ++fail_count_;
+            std::cerr << test_name << " fail: unknown exception" << std::endl;
+        }
+    }
+
+    int GetFailCount() const {
+        return fail_count_;
+    }
+
+private:
+    int fail_count_ = 0;
+};
+
+template <typename T, typename U>
+void AssertEqual(const T& t, const U& u, const std::string& hint) {
+    if (!(t == u)) {
+        std::ostringstream os;
+        os << "Assertion failed: " << t << " != " << u << " hint: " << hint;
+        throw std::runtime_error(os.str());
+    }
+}
+
+inline void Assert(bool b, const std::string& hint) {
+    if (!b) {
+        throw std::runtime_error("Assertion failed, hint: " + hint);
+    }
+}
+
+} // namespace tests
+
+#define TEST_HINT __FILE__ ":" + std::to_string(__LINE__)
+
+#define ASSERT_EQUAL(x, y) tests::AssertEqual((x), (y), #x " != " #y ", " TEST_HINT)
+
+#define ASSERT(x) tests::Assert((x), #x " is false, " TEST_HINT)
+
+// Fails unless expr throws an exception of the given type
+#define ASSERT_THROWS(expr, exception_type)                                        \
+    do {                                                                           \
+        bool thrown = false;                                                       \
+        try {                                                                      \
+            expr;                                                                  \
+        } catch (const exception_type&) {                                          \
+            thrown = true;                                                         \
+        }                                                                          \
+        tests::Assert(thrown, #expr " does not throw " #exception_type ", " TEST_HINT); \
+    } while (false)
+
+#define RUN_TEST(tr, func) tr.RunTest(func, #func)
@@ -0,0 +1,88 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace parallel {
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    for (size_t i = 1; i < thread_count; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    loop_started_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::GetThreadCount() const {
+    return workers_.size() + 1;
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& func) {
+    grain = std::max<size_t>(grain, 1);
+    if (workers_.empty() || count <= grain) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            func(begin, std::min(begin + grain, count));
+        }
+        return;
+    }
+
+    std::unique_lock lock(mutex_);
+    loop_ = Loop{&func, count, grain, 0, workers_.size(), nullptr};
+    ++generation_;
+    loop_started_.notify_all();
+    RunChunks(lock);
+    // Acts as the barrier: no worker touches the loop state after it reports being done
+    loop_finished_.wait(lock, [this] { return loop_.busy_workers == 0; });
+    loop_.func = nullptr;
+    if (loop_.error) {
+        std::rethrow_exception(std::exchange(loop_.error, nullptr));
+    }
+}
+
+void ThreadPool::WorkerLoop() {
+    size_t seen_generation = 0;
+    std::unique_lock lock(mutex_);
+    while (true) {
+        loop_started_.wait(lock, [this, seen_generation] { return stopping_ || generation_ != seen_generation; });
+        if (stopping_) {
+            return;
+        }
+        seen_generation = generation_;
+        RunChunks(lock);
+        if (--loop_.busy_workers == 0) {
+            loop_finished_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::RunChunks(std::unique_lock<std::mutex>& lock) {
+    while (loop_.next < loop_.count) {
+        const size_t begin = loop_.next;
+        const size_t end = std::min(begin + loop_.grain, loop_.count);
+        loop_.next = end;
+        const auto& func = *loop_.func;
+        lock.unlock();
+        std::exception_ptr error;
+        try {
+            func(begin, end);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        if (error && !loop_.error) {
+            loop_.error = error;
+            loop_.next = loop_.count;
+        }
+    }
+}
+
+}  // namespace parallel
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// A fixed set of worker threads for data-parallel loops. The calling thread takes part
+// in every loop, so a pool of N threads starts N - 1 workers and a pool of one runs inline.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t thread_count);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    size_t GetThreadCount() const;
+
+    // Splits [0, count) into chunks of at most grain indices, runs func(begin, end) for every
+    // chunk and returns when all of them are done. Chunks are handed out dynamically,
+    // so func must not depend on which thread runs it. The first exception thrown by func
+    // is rethrown here once the loop is over; chunks not yet started are skipped.
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& func);
+
+private:
+    struct Loop {
+        const std::function<void(size_t, size_t)>* func = nullptr;
+        size_t count = 0;
+        size_t grain = 1;
+        size_t next = 0;
+        size_t busy_workers = 0;
+        std::exception_ptr error;
+    };
+
+    void WorkerLoop();
+    void RunChunks(std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable loop_started_;
+    std::condition_variable loop_finished_;
+    Loop loop_;
+    size_t generation_ = 0;
+    bool stopping_ = false;
+};
+
+}  // namespace parallel
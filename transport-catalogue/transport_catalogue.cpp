@@ -5,36 +5,43 @@
 #include <vector>
 #include <unordered_set>
 #include <optional>
+#include <stdexcept>
 #include <iostream>
 
 using namespace std;
 
 namespace transport_catalogue{
-void TransportCatalogue::AddStop(const std::string& name, const geo::Coordinates& coordinates) {
+void TransportCatalogue::AddStop(std::string_view name, const geo::Coordinates& coordinates) {
     Stop stop;
-    stop.name_of_stop = name;
+    stop.name_of_stop = std::string(name);
     stop.coordinates = coordinates;
+    stop.id = stops_.size();
     stops_.push_back(stop);
     stopname_to_stop_[stops_.back().name_of_stop] = &stops_.back();
-    stop_to_buses_[stops_.back().name_of_stop];    
+    stop_to_buses_.emplace_back();
 }
 
-void TransportCatalogue::AddBus(const std::string& route, const vector<Stop*>& stops, bool is_round) {
+void TransportCatalogue::AddBus(std::string_view route, const vector<Stop*>& stops, bool is_round) {
     Bus bus;
-    bus.route = route;
+    bus.route = std::string(route);
     bus.is_round = is_round;
+    bus.id = all_routes_.size();
     for (Stop* stop : stops) {
         bus.stops_on_route.push_back(stop);
     }
     all_routes_.push_back(bus);
     busname_to_bus_[all_routes_.back().route] = &all_routes_.back();
     for (Stop* stop : stops) {
-        stop_to_buses_[stop->name_of_stop].insert(FindBus(route));
+        stop_to_buses_[stop->id].insert(&all_routes_.back());
     }    
 }
     
 void TransportCatalogue::SetDistance(Stop* stop_from, Stop* stop_to, int distance) {    
-        distances_[{stop_from, stop_to}] = distance; 
+    // a distance naming a stop that is not in the catalogue is ignored
+    if (stop_from == nullptr || stop_to == nullptr) {
+        return;
+    }
+    distances_.Set(stop_from->id, stop_to->id, distance); 
 }
 
 Stop* TransportCatalogue::FindStop(std::string_view stop_name) const { 
@@ -48,55 +55,64 @@ Bus* TransportCatalogue::FindBus(std::string_view bus_name) const {
 }
     
 int TransportCatalogue::GetDistance(Stop* stop_from, Stop* stop_to) const {
-    int distance{};
-    if (distances_.count({stop_from, stop_to})) {
-        distance = distances_.at({stop_from, stop_to});
-    } else {
-       distance = distances_.at({stop_to, stop_from});
+    // the reverse direction is already filled in by SetDistance
+    const std::optional<int> distance = distances_.Find(stop_from->id, stop_to->id);
+    if (!distance) {
+        throw std::out_of_range("No distance between stops "s + stop_from->name_of_stop + " and "s + stop_to->name_of_stop);
     }
-    return distance;
+    return *distance;
 }
     
 int TransportCatalogue::GetStopsCount() const {
-    return stopname_to_stop_.size();
+    return stops_.size();
 }
 
-std::vector<std::string_view> TransportCatalogue::GetStopNames() const {
-    std::vector<std::string_view> stops(stopname_to_stop_.size());
-    int i = 0;
-    for(auto&[stop, stop_ptr] : stopname_to_stop_) {
-        stops[i]=stop;
-        ++i;                
-    }
-    return stops;
+int TransportCatalogue::GetBusesCount() const {
+    return all_routes_.size();
 }
     
-optional<BusInfo> TransportCatalogue::GetBusInfo(std::string bus) const {
-    if (TransportCatalogue::FindBus(bus) == nullptr) return nullopt;
-    BusInfo bus_info;
-    bus_info.stops_on_route = (TransportCatalogue::FindBus(bus)->stops_on_route).size();
-    unordered_set<Stop*> unique_stops;
-    for (Stop* stop : TransportCatalogue::FindBus(bus)->stops_on_route) {
-        unique_stops.insert(stop);        
+void TransportCatalogue::Finalize() {
+    bus_infos_.clear();
+    bus_infos_.reserve(all_routes_.size());
+    std::vector<bool> is_counted(stops_.size());
+    for (const Bus& bus : all_routes_) {
+        BusInfo bus_info;
+        bus_info.stops_on_route = bus.stops_on_route.size();
+        for (const Stop* stop : bus.stops_on_route) {
+            if (!is_counted[stop->id]) {
+                is_counted[stop->id] = true;
+                ++bus_info.unique_stops_num;
+            }
+        }
+        for (const Stop* stop : bus.stops_on_route) {
+            is_counted[stop->id] = false;
+        }
+
+        double route_length_geo {};
+        int size = bus.stops_on_route.size();
+        for (int i = 0; i < size - 1; ++i) { 
+            route_length_geo += ComputeDistance(bus.stops_on_route[i]->coordinates, bus.stops_on_route[i+1]->coordinates);
+            bus_info.route_length += GetDistance(bus.stops_on_route[i], bus.stops_on_route[i+1]);
+        }
+        bus_info.curvature = (double)bus_info.route_length / route_length_geo;
+        bus_infos_.push_back(bus_info);
     }
-    bus_info.unique_stops_num = unique_stops.size();
+}
     
-    double route_length_geo {};
-    int size = (TransportCatalogue::FindBus(bus)->stops_on_route).size();
-    for (int i = 0; i < size - 1; ++i) { 
-        route_length_geo += ComputeDistance(TransportCatalogue::FindBus(bus)->stops_on_route[i]->coordinates, TransportCatalogue::FindBus(bus)->stops_on_route[i+1]->coordinates);
-        int distance = GetDistance(TransportCatalogue::FindBus(bus)->stops_on_route[i], TransportCatalogue::FindBus(bus)->stops_on_route[i+1]);        
-        bus_info.route_length += distance;
+optional<BusInfo> TransportCatalogue::GetBusInfo(std::string_view bus) const {
+    const Bus* bus_ptr = TransportCatalogue::FindBus(bus);
+    if (bus_ptr == nullptr) return nullopt;
+    if (bus_ptr->id >= bus_infos_.size()) {
+        throw std::logic_error("The catalogue is not finalized"s);
     }
-    bus_info.curvature = (double)bus_info.route_length / route_length_geo;
-    
-    return bus_info;    
+    return bus_infos_[bus_ptr->id];    
 }
 
-optional<StopInfo> TransportCatalogue::GetStopInfo(std::string stop) const {
-    if (TransportCatalogue::FindStop(stop) == nullptr) return nullopt;
+optional<StopInfo> TransportCatalogue::GetStopInfo(std::string_view stop) const {
+    const Stop* stop_ptr = TransportCatalogue::FindStop(stop);
+    if (stop_ptr == nullptr) return nullopt;
     StopInfo stop_info;
-    for (auto bus : stop_to_buses_.at(stop)) {
+    for (auto bus : stop_to_buses_[stop_ptr->id]) {
         stop_info.buses.insert(bus->route);
     }
     return stop_info;     
@@ -110,7 +126,20 @@ std::set<std::string_view> TransportCatalogue::GetAllBuses() const {
     return all_buses;
 }
     
-size_t TransportCatalogue::Hasher::operator()(const std::pair<Stop*, Stop*>& pair) const {        
-    return (size_t)std::hash<void*>{}(pair.first)*29 + (size_t)std::hash<void*>{}(pair.second);
+const std::deque<Stop>& TransportCatalogue::GetStops() const {
+    return stops_;
+}
+
+const std::deque<Bus>& TransportCatalogue::GetBuses() const {
+    return all_routes_;
+}
+
+std::vector<const Stop*> TransportCatalogue::GetStopsInIndexOrder() const {
+    std::vector<const Stop*> stops;
+    stops.reserve(stopname_to_stop_.size());
+    for (const auto& [name, stop] : stopname_to_stop_) {
+        stops.push_back(stop);
+    }
+    return stops;
 }
 } //namespace transport_catalogue
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "geo.h"
 #include "domain.h"
+#include "distance_table.h"
+#include <cstdint>
 #include <deque>
 #include <unordered_map>
 #include <unordered_set>
@@ -14,30 +16,43 @@
 namespace transport_catalogue{
 class TransportCatalogue {	
     public:    
-        void AddStop(const std::string& name, const geo::Coordinates& coordinates);
-        void AddBus(const std::string& route, const std::vector<Stop*>& stops, bool is_round);
+        void AddStop(std::string_view name, const geo::Coordinates& coordinates);
+        void AddBus(std::string_view route, const std::vector<Stop*>& stops, bool is_round);
         void SetDistance(Stop* stop_from, Stop* stop_to, int distance);
         Stop* FindStop(std::string_view stop_name) const;
         Bus* FindBus(std::string_view bus_name) const;
         int GetDistance(Stop* stop_from, Stop* stop_to) const;
         int GetStopsCount() const;
-        std::vector<std::string_view> GetStopNames() const;        
+        int GetBusesCount() const;
+        // Precomputes the statistics of every bus, must be called once all stops, buses and distances are added
+        void Finalize();
     
-        std::optional<BusInfo> GetBusInfo(std::string bus) const;
-        std::optional<StopInfo> GetStopInfo(std::string stop) const;
+        // Answers from the statistics computed by Finalize
+        std::optional<BusInfo> GetBusInfo(std::string_view bus) const;
+        std::optional<StopInfo> GetStopInfo(std::string_view stop) const;
         std::set<std::string_view> GetAllBuses() const;
+        // Stops and buses in the order they were added
+        const std::deque<Stop>& GetStops() const;
+        const std::deque<Bus>& GetBuses() const;
+        // Stops in the order of the name index, the routing graph numbers its stop vertices in this order
+        std::vector<const Stop*> GetStopsInIndexOrder() const;
+
+        template <typename Func>
+        void ForEachDistance(Func func) const {
+            distances_.ForEach([this, &func](uint32_t from, uint32_t to, int distance) {
+                func(&stops_[from], &stops_[to], distance);
+            });
+        }
     
     private:       
-        class Hasher {
-            public:
-                 size_t operator()(const std::pair<Stop*, Stop*>& pair) const; 
-        };
-    
         std::deque<Stop> stops_;
         std::unordered_map<std::string_view, Stop*> stopname_to_stop_;
         std::deque<Bus> all_routes_;
         std::unordered_map<std::string_view, Bus*> busname_to_bus_;
-        std::unordered_map<std::string_view, std::unordered_set<Bus*>> stop_to_buses_;
-        std::unordered_map<std::pair<Stop*, Stop*>, int, Hasher> distances_;       
+        // Indexed by stop id
+        std::vector<std::unordered_set<Bus*>> stop_to_buses_;
+        DistanceTable distances_;
+        // Indexed by bus id
+        std::vector<BusInfo> bus_infos_;       
 };
 } //namespace transport_catalogue
\ No newline at end of file
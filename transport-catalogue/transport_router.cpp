@@ -1,52 +1,214 @@
 #include "transport_router.h"
+#include "contraction_hierarchy.h"
+#include "dijkstra_router.h"
+
+#include <algorithm>
+#include <stdexcept>
 
 using namespace std::literals;
 
-TransportRouter::TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, int bus_wait_time, double bus_velocity)
+TransportRouter::TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, const RoutingSettings& settings)
     : catalogue_(catalogue)
-    , graph_(catalogue.GetStopsCount()*2)
-    , bus_wait_time_(bus_wait_time)
-    , bus_velocity_(bus_velocity) {
-        stop_indexes_.reserve(catalogue.GetStopsCount()*2);
-        int i=0;            
-        for (auto stop : catalogue.GetStopNames()) {
-            stop_to_vertex_id_[stop]=i;
-            stop_indexes_.push_back(stop);
-            stop_indexes_.push_back(stop); 
-            i+=2;
+    , bus_wait_time_(settings.bus_wait_time)
+    , bus_velocity_(settings.bus_velocity)
+    , router_type_(settings.router_type)
+    , graph_model_(settings.graph_model) {
+        //a new graph numbers the stops in the order of the catalogue name index
+        NumberStops(catalogue.GetStopsInIndexOrder());
+        switch (graph_model_) {
+            case GraphModel::SPANS:
+                graph_ = graph::DirectedWeightedGraph<double>(CountVertices(catalogue, graph_model_));
+                BuildGraph();
+                break;
+            case GraphModel::RIDE_CHAIN:
+                BuildRideChainGraph();
+                break;
         }
-        BuildGraph();
-        router_ = std::make_unique<graph::Router<double>>(graph::Router<double>(graph_));
+        BuildRouter(settings);
     }
+
+TransportRouter::TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, const RoutingSettings& settings,
+                                 RouterData data, std::optional<graph::FlatRouter<double>::Tables> tables)
+    : catalogue_(catalogue)
+    , graph_(std::move(data.graph))
+    , edge_id_to_route_(std::move(data.edge_id_to_route))
+    , bus_wait_time_(settings.bus_wait_time)
+    , bus_velocity_(settings.bus_velocity)
+    , router_type_(settings.router_type)
+    , graph_model_(settings.graph_model) {
+        std::vector<const Stop*> place_stops;
+        place_stops.reserve(data.place_stop_ids.size());
+        for (uint32_t stop_id : data.place_stop_ids) {
+            place_stops.push_back(&catalogue.GetStops().at(stop_id));
+        }
+        NumberStops(std::move(place_stops));
+        if (tables) {
+            router_ = std::make_unique<graph::FlatRouter<double>>(graph_, *tables);
+        } else {
+            BuildRouter(settings);
+        }
+    }
+
+void TransportRouter::NumberStops(std::vector<const Stop*> place_stops) {
+    place_stops_ = std::move(place_stops);
+    stop_places_.resize(place_stops_.size());
+    for (uint32_t place = 0; place < place_stops_.size(); ++place) {
+        stop_places_[place_stops_[place]->id] = place;
+    }
+}
+
+int TransportRouter::GetVerticesPerStop() const {
+    return graph_model_ == GraphModel::SPANS ? 2 : 1;
+}
+
+graph::VertexId TransportRouter::GetStopVertex(const Stop* stop) const {
+    return static_cast<graph::VertexId>(stop_places_[stop->id])*GetVerticesPerStop();
+}
+
+const Stop& TransportRouter::GetVertexStop(graph::VertexId vertex) const {
+    return *place_stops_[vertex/GetVerticesPerStop()];
+}
+
+std::vector<const Bus*> TransportRouter::GetBusesByName(const transport_catalogue::TransportCatalogue& catalogue) {
+    std::vector<const Bus*> buses;
+    buses.reserve(catalogue.GetBusesCount());
+    for (const Bus& bus : catalogue.GetBuses()) {
+        buses.push_back(&bus);
+    }
+    std::sort(buses.begin(), buses.end(), [](const Bus* left, const Bus* right) {
+        return left->route < right->route;
+    });
+    return buses;
+}
+
+template <typename Func>
+void TransportRouter::ForEachChain(const std::vector<const Bus*>& buses, Func func) {
+    //a non-round route is split at its turnaround like in BuildGraph
+    for (const Bus* bus : buses) {
+        const int stop_count = bus->stops_on_route.size();
+        if (bus->is_round) {
+            func(0, stop_count, bus);
+        } else {
+            func(0, std::min(stop_count/2+1, stop_count), bus);
+            func(stop_count/2, stop_count, bus);
+        }
+    }
+}
+
+size_t TransportRouter::CountVertices(const transport_catalogue::TransportCatalogue& catalogue, GraphModel graph_model) {
+    if (graph_model == GraphModel::SPANS) {
+        return static_cast<size_t>(catalogue.GetStopsCount())*2;
+    }
+    size_t vertex_count = catalogue.GetStopsCount();
+    ForEachChain(GetBusesByName(catalogue), [&vertex_count](int first_stop, int last_stop, const Bus*) {
+        vertex_count += last_stop - first_stop;
+    });
+    return vertex_count;
+}
+
 void TransportRouter::BuildGraph() {
     //creates edges for waiting on every stop
-    edge_id_to_route_.reserve(stop_indexes_.size()/2);
-    for (long unsigned int i = 0; i < stop_indexes_.size(); ++i) {
+    edge_id_to_route_.reserve(graph_.GetVertexCount()/2);
+    for (long unsigned int i = 0; i < graph_.GetVertexCount(); ++i) {
         graph_.AddEdge({i, ++i, (double)bus_wait_time_});
         edge_id_to_route_.push_back(std::nullopt);            
     }
 
     //creates edges for all stops       
-    for(auto bus_string_view : catalogue_.GetAllBuses()) {
-        auto bus = catalogue_.FindBus(bus_string_view);
-
+    for(const Bus* bus : GetBusesByName(catalogue_)) {
         if (bus->is_round) {                
-            BuildEdges(0, bus->stops_on_route.size(), bus, bus_string_view);  
+            BuildEdges(0, bus->stops_on_route.size(), bus);  
         } else {                
-            BuildEdges(0, bus->stops_on_route.size()/2+1,bus, bus_string_view);  
-            BuildEdges(bus->stops_on_route.size()/2, bus->stops_on_route.size(), bus, bus_string_view); 
+            BuildEdges(0, bus->stops_on_route.size()/2+1, bus);  
+            BuildEdges(bus->stops_on_route.size()/2, bus->stops_on_route.size(), bus); 
         }           
     }       
 }
 
+void TransportRouter::BuildRouter(const RoutingSettings& settings) {
+    switch (settings.router_type) {
+        case RouterType::ALL_PAIRS:
+            router_ = std::make_unique<graph::Router<double>>(graph_);
+            break;
+        case RouterType::ALL_PAIRS_FLAT:
+            router_ = std::make_unique<graph::FlatRouter<double>>(graph_, settings.thread_count);
+            break;
+        case RouterType::DIJKSTRA:
+            router_ = std::make_unique<graph::DijkstraRouter<double>>(graph_);
+            break;
+        case RouterType::CONTRACTION_HIERARCHY:
+            router_ = std::make_unique<graph::ContractionHierarchy<double>>(graph_);
+            break;
+    }
+}
+
+void TransportRouter::BuildRideChainGraph() {
+    graph_ = graph::DirectedWeightedGraph<double>(CountVertices(catalogue_, graph_model_));
+
+    graph::VertexId first_vertex = catalogue_.GetStopsCount();
+    ForEachChain(GetBusesByName(catalogue_), [this, &first_vertex](int first_stop, int last_stop, const Bus* bus) {
+        BuildRideChain(first_stop, last_stop, first_vertex, bus);
+        first_vertex += last_stop - first_stop;
+    });
+}
+
+void TransportRouter::BuildRideChain(int first_stop, int last_stop, graph::VertexId first_vertex, const Bus* bus) {
+    for (int i = first_stop; i < last_stop; ++i) {
+        const graph::VertexId stop_vertex = GetStopVertex(bus->stops_on_route[i]);
+        const graph::VertexId ride_vertex = first_vertex + (i - first_stop);
+        //boarding takes the wait at the stop, alighting is free
+        graph_.AddEdge({stop_vertex, ride_vertex, (double)bus_wait_time_});
+        edge_id_to_route_.push_back(std::nullopt);
+        graph_.AddEdge({ride_vertex, stop_vertex, 0.});
+        edge_id_to_route_.push_back(std::pair<uint32_t, int>{bus->id, 0});
+        if (i + 1 < last_stop) {
+            const double distance = catalogue_.GetDistance(bus->stops_on_route[i], bus->stops_on_route[i+1]);
+            graph_.AddEdge({ride_vertex, ride_vertex + 1, distance / bus_velocity_});
+            edge_id_to_route_.push_back(std::pair<uint32_t, int>{bus->id, 1});
+        }
+    }
+}
+
 const graph::DirectedWeightedGraph<double>& TransportRouter::GetGraph() const {
     return graph_;
 }
 
-RouteReqInfo TransportRouter::GetRoutesInfo(const std::string& from, const std::string& to) {
+RoutingSettings TransportRouter::GetRoutingSettings() const {
+    RoutingSettings settings;
+    settings.bus_wait_time = bus_wait_time_;
+    settings.bus_velocity = bus_velocity_;
+    settings.router_type = router_type_;
+    settings.graph_model = graph_model_;
+    return settings;
+}
+
+const std::vector<std::optional<std::pair<uint32_t, int>>>& TransportRouter::GetEdgeIdToRoute() const {
+    return edge_id_to_route_;
+}
+
+std::vector<uint32_t> TransportRouter::GetPlaceStopIds() const {
+    std::vector<uint32_t> place_stop_ids;
+    place_stop_ids.reserve(place_stops_.size());
+    for (const Stop* stop : place_stops_) {
+        place_stop_ids.push_back(stop->id);
+    }
+    return place_stop_ids;
+}
+
+std::optional<graph::FlatRouter<double>::Tables> TransportRouter::GetFlatTables() const {
+    if (const auto* flat_router = dynamic_cast<const graph::FlatRouter<double>*>(router_.get())) {
+        return flat_router->GetTables();
+    }
+    return std::nullopt;
+}
+
+RouteReqInfo TransportRouter::GetRoutesInfo(const Stop* from, const Stop* to) const {
+    if (from == nullptr || to == nullptr) {
+        throw std::out_of_range("Unknown stop in a route request"s);
+    }
     RouteReqInfo route_req_info;
     
-    auto route_info =  router_->BuildRoute(stop_to_vertex_id_.at(from), stop_to_vertex_id_.at(to));
+    auto route_info =  router_->BuildRoute(GetStopVertex(from), GetStopVertex(to));
     if (!route_info) {           
         route_req_info.route_info = std::nullopt;          
     } else {           
@@ -54,14 +216,20 @@ RouteReqInfo TransportRouter::GetRoutesInfo(const std::string& from, const std::
         std::vector<ActivityInfo> info_result;
 
         for (const auto& edge : route_info.value().edges) {
+            //a ride chain describes one trip with several edges, they add up to a single item
+            if (edge_id_to_route_.at(edge) && !info_result.empty() && info_result.back().type == "Bus"s) {
+                info_result.back().span_count += edge_id_to_route_.at(edge).value().second;
+                info_result.back().time += graph_.GetEdge(edge).weight;
+                continue;
+            }
             ActivityInfo activity;
             if (edge_id_to_route_.at(edge) == std::nullopt) {
                 activity.type = "Wait"s;
-                activity.stop_name = stop_indexes_.at(graph_.GetEdge(edge).from);
+                activity.stop_name = GetVertexStop(graph_.GetEdge(edge).from).name_of_stop;
                 activity.time = bus_wait_time_;
             } else {
                 activity.type = "Bus"s;
-                activity.bus_name = edge_id_to_route_.at(edge).value().first;
+                activity.bus_name = catalogue_.GetBuses()[edge_id_to_route_.at(edge).value().first].route;
                 activity.span_count = edge_id_to_route_.at(edge).value().second;
                 activity.time = graph_.GetEdge(edge).weight;
             }
@@ -72,16 +240,16 @@ RouteReqInfo TransportRouter::GetRoutesInfo(const std::string& from, const std::
     return route_req_info;
 }
 
-void TransportRouter::BuildEdges(int external_cycle_var, int max_stop, Bus* bus, std::string_view bus_string_view) {                            
+void TransportRouter::BuildEdges(int external_cycle_var, int max_stop, const Bus* bus) {                            
     for (int i = external_cycle_var; i<max_stop; ++i) { 
         double cur_distance{};
+        const graph::VertexId from_vertex = GetStopVertex(bus->stops_on_route[i]);
         for (int j = i+1; j<max_stop; ++j) {                        
-            if (stop_to_vertex_id_.at(bus->stops_on_route[i]->name_of_stop) != stop_to_vertex_id_.at(bus->stops_on_route[j]->name_of_stop)) {
+            const graph::VertexId to_vertex = GetStopVertex(bus->stops_on_route[j]);
+            if (from_vertex != to_vertex) {
                 cur_distance+=(double)catalogue_.GetDistance(bus->stops_on_route[j-1], bus->stops_on_route[j]);
-                graph_.AddEdge({stop_to_vertex_id_.at(bus->stops_on_route[i]->name_of_stop)+1,
-                                stop_to_vertex_id_.at(bus->stops_on_route[j]->name_of_stop),
-                                cur_distance / bus_velocity_});
-                edge_id_to_route_.push_back(std::pair<std::string_view, double>{bus_string_view, std::abs(i-j)});
+                graph_.AddEdge({from_vertex+1, to_vertex, cur_distance / bus_velocity_});
+                edge_id_to_route_.push_back(std::pair<uint32_t, int>{bus->id, std::abs(i-j)});
             }
         }
     }
@@ -1,8 +1,36 @@
 #pragma once
 
+#include "flat_router.h"
 #include "router.h"
 #include "transport_catalogue.h"
+#include <cstdint>
 #include <memory>
+#include <optional>
+
+enum class RouterType {
+    ALL_PAIRS,
+    ALL_PAIRS_FLAT,
+    DIJKSTRA,
+    CONTRACTION_HIERARCHY,
+};
+
+enum class GraphModel {
+    // Every stop has an arrival and a departure vertex, and each bus links every stop
+    // with every later one, which is quadratic in the route length
+    SPANS,
+    // Every stop has one vertex, and each bus has a chain of ride vertices linked between
+    // consecutive stops, entered by boarding (the wait) and left by alighting
+    RIDE_CHAIN,
+};
+
+struct RoutingSettings {
+    int bus_wait_time{};
+    double bus_velocity{};
+    RouterType router_type = RouterType::ALL_PAIRS;
+    GraphModel graph_model = GraphModel::SPANS;
+    // Worker threads for precomputing the all_pairs_flat tables and answering stat_requests
+    size_t thread_count = 1;
+};
 
 struct ActivityInfo {
     std::string type;
@@ -17,23 +45,61 @@ struct RouteReqInfo {
     double total_time;
 };
 
+// The graph and lookup tables TransportRouter derives from the catalogue
+struct RouterData {
+    graph::DirectedWeightedGraph<double> graph;
+    std::vector<std::optional<std::pair<uint32_t, int>>> edge_id_to_route;
+    // Stop id of every place among the stop vertices
+    std::vector<uint32_t> place_stop_ids;
+};
+
 class TransportRouter {
 public:
-    TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, int bus_wait_time, double bus_velocity);    
+    TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, const RoutingSettings& settings);    
+    // Restores a router saved by make_base; all-pairs tables, when given, are used in place
+    TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, const RoutingSettings& settings,
+                    RouterData data, std::optional<graph::FlatRouter<double>::Tables> tables);
     const graph::DirectedWeightedGraph<double>& GetGraph() const;
-    RouteReqInfo GetRoutesInfo(const std::string& from, const std::string& to);    
+    // Only reads the router, so it can be called from several threads at once
+    RouteReqInfo GetRoutesInfo(const Stop* from, const Stop* to) const;
+
+    RoutingSettings GetRoutingSettings() const;
+    const std::vector<std::optional<std::pair<uint32_t, int>>>& GetEdgeIdToRoute() const;
+    // Stop id of every place among the stop vertices, the stop of a vertex depends on this order
+    std::vector<uint32_t> GetPlaceStopIds() const;
+    // Vertices of the graph built for the catalogue with the given model
+    static size_t CountVertices(const transport_catalogue::TransportCatalogue& catalogue, GraphModel graph_model);
+    // Tables of the all_pairs_flat engine, nullopt for the other engines
+    std::optional<graph::FlatRouter<double>::Tables> GetFlatTables() const;
     
 private:
     const transport_catalogue::TransportCatalogue& catalogue_;
     graph::DirectedWeightedGraph<double> graph_;
-    std::vector<std::string_view>stop_indexes_;
-    std::unordered_map<std::string_view, long unsigned int>stop_to_vertex_id_;
-    //stores name of the route and number of stops for each edge
-    std::vector<std::optional<std::pair<std::string_view, int>>>edge_id_to_route_;
+    //stores id of the bus and number of stops for each edge, nullopt for waiting;
+    //edges of a ride chain take one stop each and alighting takes none
+    std::vector<std::optional<std::pair<uint32_t, int>>>edge_id_to_route_;
     int bus_wait_time_;
     double bus_velocity_;
-    std::unique_ptr<graph::Router<double>> router_;
+    RouterType router_type_;
+    GraphModel graph_model_;
+    std::unique_ptr<graph::RoutingEngine<double>> router_;
+    //the place of every stop among the stop vertices by stop id, and the stop of every place
+    std::vector<uint32_t> stop_places_;
+    std::vector<const Stop*> place_stops_;
     
+    //stops take vertices in the order of place_stops, a ride chain model puts ride vertices after them
+    void NumberStops(std::vector<const Stop*> place_stops);
+    int GetVerticesPerStop() const;
+    graph::VertexId GetStopVertex(const Stop* stop) const;
+    const Stop& GetVertexStop(graph::VertexId vertex) const;
+    //buses ordered by name: the edges go in this order, so equal-time routes keep the bus they always had
+    static std::vector<const Bus*> GetBusesByName(const transport_catalogue::TransportCatalogue& catalogue);
+    //calls func(first_stop, last_stop, bus) for the ride chain of every bus
+    template <typename Func>
+    static void ForEachChain(const std::vector<const Bus*>& buses, Func func);
     void BuildGraph();
-    void BuildEdges(int external_cycle_var, int max_stop, Bus* bus, std::string_view bus_string_view);
+    void BuildRouter(const RoutingSettings& settings);
+    void BuildEdges(int external_cycle_var, int max_stop, const Bus* bus);
+    void BuildRideChainGraph();
+    void BuildRideChain(int first_stop, int last_stop, graph::VertexId first_vertex, const Bus* bus);
 };